@@ -0,0 +1,306 @@
+// allocator_benchmarks.cpp
+
+#include <cstdlib>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "benchmark.hpp"
+#include "../engine/src/memory_pool.hpp"
+
+using namespace types;
+
+namespace triton
+{
+    static constexpr usize K_ALIGNMENT = 8;
+
+    class cEngineAllocatorPolicy
+    {
+    public:
+        explicit cEngineAllocatorPolicy() { _allocator.SetBins(sMemoryAllocatorDescriptor()); }
+
+        static const char* GetName() { return "engine"; }
+
+        inline void* Allocate(usize byteSize) { return _allocator.Allocate(byteSize, K_ALIGNMENT); }
+        inline void Deallocate(void* ptr) { _allocator.Deallocate(ptr); }
+        inline usize GetMappedByteSize() const { return _allocator.GetMappedByteSize(); }
+
+    private:
+        cMemoryAllocator _allocator;
+    };
+
+    class cSystemAllocatorPolicy
+    {
+    public:
+        static const char* GetName() { return "malloc"; }
+
+        inline void* Allocate(usize byteSize) { return std::malloc(byteSize); }
+        inline void Deallocate(void* ptr) { std::free(ptr); }
+        inline usize GetMappedByteSize() const { return 0; }
+    };
+
+    // Size mix approximated from the engine's allocation sites: transforms and small objects,
+    // event payloads, glyph bitmaps, hash table chunks and occasional sound/staging buffers
+    static usize GetMixedByteSize(cBenchmarkRandom& random)
+    {
+        const usize bucket = random.Range(100);
+        if (bucket < 30)
+            return 16 + random.Range(48);
+        else if (bucket < 65)
+            return 64 + random.Range(192);
+        else if (bucket < 85)
+            return 256 + random.Range(768);
+        else if (bucket < 97)
+            return 4096 + random.Range(12288);
+        else
+            return 64 * 1024 + random.Range(192 * 1024);
+    }
+
+    template <typename T>
+    static f64 RunChurn(T& allocator, usize liveCount, usize operationCount, types::boolean mixedSizes)
+    {
+        cBenchmarkRandom random(liveCount);
+        std::vector<void*> slots(liveCount, nullptr);
+        for (usize i = 0; i < liveCount; i++)
+            slots[i] = allocator.Allocate(mixedSizes ? GetMixedByteSize(random) : 64);
+
+        cBenchmarkTimer timer;
+        for (usize i = 0; i < operationCount; i++)
+        {
+            const usize slot = random.Range(liveCount);
+            allocator.Deallocate(slots[slot]);
+            slots[slot] = allocator.Allocate(mixedSizes ? GetMixedByteSize(random) : 64);
+            *(volatile u8*)slots[slot] = (u8)i;
+        }
+        const f64 nanoseconds = timer.GetNanoseconds();
+
+        for (usize i = 0; i < liveCount; i++)
+            allocator.Deallocate(slots[i]);
+
+        return nanoseconds / (f64)(operationCount * 2);
+    }
+
+    template <typename T>
+    static void RunChurnBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        T allocator;
+        const f64 nsPerOperation = RunChurn(allocator, 4096, 2000000, K_FALSE);
+
+        AddBenchmarkResult(results, "allocator.churn", T::GetName(), { { "nsPerOp", nsPerOperation }, { "rssByteSize", (f64)GetResidentByteSize() } });
+    }
+
+    template <typename T>
+    static void RunMixedBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        T allocator;
+        const f64 nsPerOperation = RunChurn(allocator, 16384, 1000000, K_TRUE);
+
+        AddBenchmarkResult(results, "allocator.mixed", T::GetName(), { { "nsPerOp", nsPerOperation }, { "rssByteSize", (f64)GetResidentByteSize() } });
+    }
+
+    template <typename T>
+    static void RunLatencyBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        // Latency should stay flat as the live object count grows
+        for (usize liveCount = 1; liveCount <= 100000; liveCount *= 10)
+        {
+            T allocator;
+            const f64 nsPerOperation = RunChurn(allocator, liveCount, 1000000, K_FALSE);
+
+            AddBenchmarkResult(results, "allocator.latency", T::GetName(), { { "liveCount", (f64)liveCount }, { "nsPerOp", nsPerOperation } });
+        }
+    }
+
+    template <typename T>
+    static void RunScalingBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        usize maxThreadCount = std::thread::hardware_concurrency();
+        if (maxThreadCount == 0)
+            maxThreadCount = 1;
+
+        std::vector<usize> threadCounts;
+        for (usize threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+            threadCounts.push_back(threadCount);
+        threadCounts.push_back(maxThreadCount);
+
+        const usize operationCount = 1000000;
+        for (const usize threadCount : threadCounts)
+        {
+            T allocator;
+            std::vector<std::thread> threads;
+
+            cBenchmarkTimer timer;
+            for (usize i = 0; i < threadCount; i++)
+                threads.emplace_back([&allocator, operationCount]() { RunChurn(allocator, 1024, operationCount, K_FALSE); });
+            for (auto& thread : threads)
+                thread.join();
+            const f64 nanoseconds = timer.GetNanoseconds();
+
+            const f64 totalOperationCount = (f64)(threadCount * operationCount * 2);
+            AddBenchmarkResult(results, "allocator.scaling", T::GetName(), {
+                { "threadCount", (f64)threadCount },
+                { "nsPerOp", nanoseconds / totalOperationCount },
+                { "opsPerSecond", totalOperationCount / (nanoseconds * 1e-9) }
+            });
+        }
+    }
+
+    template <typename T>
+    static void RunProducerConsumerBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        // Every block is freed by a different thread than the one that allocated it
+        static constexpr usize K_RING_SIZE = 1024;
+        struct sRing
+        {
+            std::atomic<usize> head = { 0 };
+            std::atomic<usize> tail = { 0 };
+            void* blocks[K_RING_SIZE] = {};
+        };
+
+        usize pairCount = std::thread::hardware_concurrency() / 2;
+        if (pairCount == 0)
+            pairCount = 1;
+
+        const usize blockCount = 1000000;
+        T allocator;
+        std::vector<sRing> rings(pairCount);
+        std::vector<std::thread> threads;
+
+        cBenchmarkTimer timer;
+        for (usize i = 0; i < pairCount; i++)
+        {
+            sRing* ring = &rings[i];
+            threads.emplace_back([&allocator, ring, blockCount, i]()
+            {
+                cBenchmarkRandom random(i + 1);
+                for (usize j = 0; j < blockCount; j++)
+                {
+                    void* block = allocator.Allocate(16 + random.Range(240));
+                    const usize head = ring->head.load(std::memory_order_relaxed);
+                    while (head - ring->tail.load(std::memory_order_acquire) >= K_RING_SIZE)
+                        std::this_thread::yield();
+                    ring->blocks[head % K_RING_SIZE] = block;
+                    ring->head.store(head + 1, std::memory_order_release);
+                }
+            });
+            threads.emplace_back([&allocator, ring, blockCount]()
+            {
+                for (usize j = 0; j < blockCount; j++)
+                {
+                    const usize tail = ring->tail.load(std::memory_order_relaxed);
+                    while (ring->head.load(std::memory_order_acquire) == tail)
+                        std::this_thread::yield();
+                    allocator.Deallocate(ring->blocks[tail % K_RING_SIZE]);
+                    ring->tail.store(tail + 1, std::memory_order_release);
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+        const f64 nanoseconds = timer.GetNanoseconds();
+
+        const f64 totalOperationCount = (f64)(pairCount * blockCount * 2);
+        AddBenchmarkResult(results, "allocator.producer_consumer", T::GetName(), {
+            { "threadCount", (f64)(pairCount * 2) },
+            { "nsPerOp", nanoseconds / totalOperationCount },
+            { "rssByteSize", (f64)GetResidentByteSize() }
+        });
+    }
+
+    template <typename T>
+    static void RunFragmentationBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        // Fill, free most blocks at random and refill with a shifted size mix, the way long sessions age the heap
+        const usize roundCount = 20;
+        const usize blockCount = 65536;
+        const usize baseResidentByteSize = GetResidentByteSize();
+
+        T allocator;
+        cBenchmarkRandom random(42);
+        std::vector<void*> blocks(blockCount, nullptr);
+        std::vector<usize> byteSizes(blockCount, 0);
+        usize liveByteSize = 0;
+
+        cBenchmarkTimer timer;
+        for (usize round = 0; round < roundCount; round++)
+        {
+            for (usize i = 0; i < blockCount; i++)
+            {
+                if (blocks[i] != nullptr && random.Range(4) != 0)
+                {
+                    allocator.Deallocate(blocks[i]);
+                    liveByteSize -= byteSizes[i];
+                    blocks[i] = nullptr;
+                }
+            }
+
+            for (usize i = 0; i < blockCount; i++)
+            {
+                if (blocks[i] != nullptr)
+                    continue;
+
+                byteSizes[i] = (round & 1) != 0 ? 16 + random.Range(112) : GetMixedByteSize(random);
+                if (byteSizes[i] > 16 * 1024)
+                    byteSizes[i] = 16 * 1024;
+                blocks[i] = allocator.Allocate(byteSizes[i]);
+                for (usize j = 0; j < byteSizes[i]; j += 4096)
+                    ((volatile u8*)blocks[i])[j] = (u8)j;
+                liveByteSize += byteSizes[i];
+            }
+        }
+        const f64 nanoseconds = timer.GetNanoseconds();
+
+        const usize residentByteSize = GetResidentByteSize();
+        const usize footprintByteSize = residentByteSize > baseResidentByteSize ? residentByteSize - baseResidentByteSize : 0;
+        const f64 fragmentation = footprintByteSize > liveByteSize ? 1.0 - (f64)liveByteSize / (f64)footprintByteSize : 0.0;
+
+        AddBenchmarkResult(results, "allocator.fragmentation", T::GetName(), {
+            { "nsPerRound", nanoseconds / (f64)roundCount },
+            { "liveByteSize", (f64)liveByteSize },
+            { "rssByteSize", (f64)footprintByteSize },
+            { "mappedByteSize", (f64)allocator.GetMappedByteSize() },
+            { "fragmentation", fragmentation }
+        });
+
+        for (usize i = 0; i < blockCount; i++)
+            allocator.Deallocate(blocks[i]);
+    }
+
+    void RunAllocatorBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results)
+    {
+        if (IsBenchmarkSelected(filter, "allocator.churn"))
+        {
+            RunChurnBenchmark<cEngineAllocatorPolicy>(results);
+            RunChurnBenchmark<cSystemAllocatorPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "allocator.mixed"))
+        {
+            RunMixedBenchmark<cEngineAllocatorPolicy>(results);
+            RunMixedBenchmark<cSystemAllocatorPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "allocator.latency"))
+        {
+            RunLatencyBenchmark<cEngineAllocatorPolicy>(results);
+            RunLatencyBenchmark<cSystemAllocatorPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "allocator.scaling"))
+        {
+            RunScalingBenchmark<cEngineAllocatorPolicy>(results);
+            RunScalingBenchmark<cSystemAllocatorPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "allocator.producer_consumer"))
+        {
+            RunProducerConsumerBenchmark<cEngineAllocatorPolicy>(results);
+            RunProducerConsumerBenchmark<cSystemAllocatorPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "allocator.fragmentation"))
+        {
+            RunFragmentationBenchmark<cEngineAllocatorPolicy>(results);
+            RunFragmentationBenchmark<cSystemAllocatorPolicy>(results);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+// benchmark.hpp
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include "../engine/src/types.hpp"
+
+namespace triton
+{
+    struct sBenchmarkMetric
+    {
+        std::string name;
+        types::f64 value = 0.0;
+    };
+
+    struct sBenchmarkResult
+    {
+        std::string benchmark;
+        std::string variant;
+        std::vector<sBenchmarkMetric> metrics;
+    };
+
+    class cBenchmarkTimer
+    {
+    public:
+        explicit cBenchmarkTimer() : _start(std::chrono::steady_clock::now()) {}
+
+        inline types::f64 GetNanoseconds() const { return std::chrono::duration<types::f64, std::nano>(std::chrono::steady_clock::now() - _start).count(); }
+
+    private:
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    class cBenchmarkRandom
+    {
+    public:
+        explicit cBenchmarkRandom(types::u64 seed) : _state(seed != 0 ? seed : 0x9E3779B97F4A7C15ull) {}
+
+        inline types::u64 Next()
+        {
+            _state ^= _state << 13;
+            _state ^= _state >> 7;
+            _state ^= _state << 17;
+
+            return _state;
+        }
+
+        inline types::usize Range(types::usize count) { return (types::usize)(Next() % count); }
+
+    private:
+        types::u64 _state = 0;
+    };
+
+    types::usize GetResidentByteSize();
+    std::string MakeBenchmarkJson(const std::vector<sBenchmarkResult>& results);
+    types::boolean IsBenchmarkSelected(const std::string& filter, const std::string& name);
+    void AddBenchmarkResult(std::vector<sBenchmarkResult>& results, const std::string& benchmark, const std::string& variant, const std::vector<sBenchmarkMetric>& metrics);
+
+    void RunAllocatorBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results);
+    void RunHashBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results);
+    void RunCacheBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results);
+    void RunThreadBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results);
+}
\ No newline at end of file
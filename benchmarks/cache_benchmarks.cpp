@@ -0,0 +1,371 @@
+// cache_benchmarks.cpp
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <shared_mutex>
+#include <unordered_map>
+#include "benchmark.hpp"
+#include "../engine/src/capabilities.hpp"
+#include "../engine/src/context.hpp"
+#include "../engine/src/concurrent_cache.hpp"
+#include "../engine/src/pool.hpp"
+#include "../engine/src/log.hpp"
+
+using namespace types;
+
+namespace triton
+{
+    static constexpr u64 K_ACTOR_CHECK = 0xA5A5A5A5A5A5A5A5ull;
+
+    class cBenchmarkActor : public iObject
+    {
+        TRITON_OBJECT(cBenchmarkActor)
+
+    public:
+        explicit cBenchmarkActor(cContext* context, u64 value) : iObject(context), _value(value), _check(value ^ K_ACTOR_CHECK) {}
+        virtual ~cBenchmarkActor() override final { _check = 0; }
+
+        // A destroyed or half-built actor fails this check
+        inline types::boolean IsValid() const { return _check == (_value ^ K_ACTOR_CHECK) ? K_TRUE : K_FALSE; }
+
+    private:
+        u64 _value = 0;
+        u64 _check = 0;
+    };
+
+    // Pool elements are swap-moved on destroy, so unlike the cached actors they carry a move constructor
+    class cBenchmarkPoolActor : public iObject
+    {
+        TRITON_OBJECT(cBenchmarkPoolActor)
+
+    public:
+        explicit cBenchmarkPoolActor(cContext* context, u64 value) : iObject(context), _value(value), _check(value ^ K_ACTOR_CHECK) {}
+        cBenchmarkPoolActor(cBenchmarkPoolActor&& rhs) noexcept : iObject(rhs._context), _value(rhs._value), _check(rhs._check)
+        {
+            _id = rhs._id;
+            rhs._check = 0;
+        }
+        virtual ~cBenchmarkPoolActor() override final { _check = 0; }
+
+        inline types::boolean IsValid(u64 value) const { return _value == value && _check == (value ^ K_ACTOR_CHECK) ? K_TRUE : K_FALSE; }
+        inline u64 GetValue() const { return _value; }
+
+    private:
+        u64 _value = 0;
+        u64 _check = 0;
+    };
+
+    class cConcurrentCachePolicy
+    {
+    public:
+        explicit cConcurrentCachePolicy(cContext* context, const sChunkAllocatorDescriptor& desc) : _context(context), _cache(context, desc) {}
+
+        static const char* GetName() { return "concurrent_cache"; }
+
+        inline cTag Create(u64 value) { return _cache.Create(_context, value)->GetID(); }
+        inline void Destroy(const cTag& id) { _cache.Destroy(id); }
+        inline usize GetElementCount() const { return _cache.GetElementCount(); }
+
+        // Returns 0 for a miss, 1 for a valid hit and 2 for a hit on a broken object
+        inline u32 Lookup(const cTag& id) const
+        {
+            cEpochReadScope scope(_cache.GetEpochDomain());
+            const cBenchmarkActor* actor = _cache.Find(id);
+            if (actor == nullptr)
+                return 0;
+
+            return actor->IsValid() == K_TRUE && actor->GetID() == id ? 1 : 2;
+        }
+
+    private:
+        cContext* _context = nullptr;
+        cConcurrentCache<cBenchmarkActor> _cache;
+    };
+
+    class cSharedMutexPolicy
+    {
+    public:
+        explicit cSharedMutexPolicy(cContext* context, const sChunkAllocatorDescriptor&) : _context(context) {}
+
+        ~cSharedMutexPolicy()
+        {
+            for (auto& object : _objects)
+                DestroyActor(object.second);
+        }
+
+        static const char* GetName() { return "shared_mutex"; }
+
+        inline cTag Create(u64 value)
+        {
+            u8* memory = (u8*)::operator new(sizeof(cBenchmarkActor));
+            cBenchmarkActor* actor = _context->Create<cBenchmarkActor>(memory, (u32)0, _context, value);
+
+            std::unique_lock<std::shared_mutex> lock(_mutex);
+            _objects.insert({ actor->GetID(), actor });
+
+            return actor->GetID();
+        }
+
+        inline void Destroy(const cTag& id)
+        {
+            cBenchmarkActor* actor = nullptr;
+            {
+                std::unique_lock<std::shared_mutex> lock(_mutex);
+                const auto it = _objects.find(id);
+                if (it == _objects.end())
+                    return;
+                actor = it->second;
+                _objects.erase(it);
+            }
+            DestroyActor(actor);
+        }
+
+        inline usize GetElementCount() const
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+
+            return _objects.size();
+        }
+
+        inline u32 Lookup(const cTag& id) const
+        {
+            std::shared_lock<std::shared_mutex> lock(_mutex);
+            const auto it = _objects.find(id);
+            if (it == _objects.end())
+                return 0;
+
+            return it->second->IsValid() == K_TRUE && it->second->GetID() == id ? 1 : 2;
+        }
+
+    private:
+        inline void DestroyActor(cBenchmarkActor* actor)
+        {
+            _context->DestroyInPlace(actor);
+            ::operator delete(actor);
+        }
+
+    private:
+        cContext* _context = nullptr;
+        std::unordered_map<cTag, cBenchmarkActor*, sTagHasher> _objects;
+        mutable std::shared_mutex _mutex;
+    };
+
+    struct sCacheBenchmarkStats
+    {
+        f64 nanoseconds = 0.0;
+        u64 lookupCount = 0;
+        u64 hitCount = 0;
+        u64 errorCount = 0;
+        u64 writeCount = 0;
+        u64 finalCountMismatch = 0;
+    };
+
+    // One writer keeps churning a live set of actors while the readers look up ids the writer published.
+    // Published ids are written once and never modified, readers only pick indices below the published count.
+    template <typename T>
+    static sCacheBenchmarkStats RunCacheWorkload(cContext* context, usize readerCount, usize liveCount, usize writeCount, const sChunkAllocatorDescriptor& desc)
+    {
+        T cache(context, desc);
+
+        std::vector<cTag> ids(liveCount + writeCount);
+        std::atomic<usize> publishedCount = { 0 };
+        std::atomic<types::boolean> running = { K_TRUE };
+        std::vector<u64> lookupCounts(readerCount, 0);
+        std::vector<u64> hitCounts(readerCount, 0);
+        std::vector<u64> errorCounts(readerCount, 0);
+
+        for (usize i = 0; i < liveCount; i++)
+            ids[i] = cache.Create(i);
+        publishedCount.store(liveCount, std::memory_order_release);
+
+        std::vector<std::thread> readers;
+        for (usize i = 0; i < readerCount; i++)
+        {
+            readers.emplace_back([&, i]()
+            {
+                cBenchmarkRandom random(i + 1);
+                u64 lookupCount = 0;
+                u64 hitCount = 0;
+                u64 errorCount = 0;
+                while (running.load(std::memory_order_relaxed) == K_TRUE)
+                {
+                    const usize count = publishedCount.load(std::memory_order_acquire);
+                    for (usize j = 0; j < 256; j++)
+                    {
+                        // Bias towards recent ids so most lookups hit live actors
+                        const usize window = count < liveCount * 2 ? count : liveCount * 2;
+                        const u32 result = cache.Lookup(ids[count - 1 - random.Range(window)]);
+                        hitCount += result == 1 ? 1 : 0;
+                        errorCount += result == 2 ? 1 : 0;
+                    }
+                    lookupCount += 256;
+                }
+                lookupCounts[i] = lookupCount;
+                hitCounts[i] = hitCount;
+                errorCounts[i] = errorCount;
+            });
+        }
+
+        cBenchmarkTimer timer;
+        for (usize i = 0; i < writeCount; i++)
+        {
+            cache.Destroy(ids[i]);
+            ids[liveCount + i] = cache.Create(liveCount + i);
+            publishedCount.store(liveCount + i + 1, std::memory_order_release);
+        }
+        const f64 nanoseconds = timer.GetNanoseconds();
+
+        running.store(K_FALSE, std::memory_order_relaxed);
+        for (auto& reader : readers)
+            reader.join();
+
+        sCacheBenchmarkStats stats;
+        stats.nanoseconds = nanoseconds;
+        stats.writeCount = writeCount * 2;
+        stats.finalCountMismatch = cache.GetElementCount() != liveCount ? 1 : 0;
+        for (usize i = 0; i < readerCount; i++)
+        {
+            stats.lookupCount += lookupCounts[i];
+            stats.hitCount += hitCounts[i];
+            stats.errorCount += errorCounts[i];
+        }
+
+        return stats;
+    }
+
+    template <typename T>
+    static void RunConcurrentCacheBenchmark(cContext* context, std::vector<sBenchmarkResult>& results)
+    {
+        usize maxReaderCount = std::thread::hardware_concurrency();
+        maxReaderCount = maxReaderCount > 1 ? maxReaderCount - 1 : 1;
+
+        std::vector<usize> readerCounts;
+        for (usize readerCount = 1; readerCount < maxReaderCount; readerCount *= 2)
+            readerCounts.push_back(readerCount);
+        readerCounts.push_back(maxReaderCount);
+
+        for (const usize readerCount : readerCounts)
+        {
+            const sCacheBenchmarkStats stats = RunCacheWorkload<T>(context, readerCount, 16 * 1024, 200000, sChunkAllocatorDescriptor());
+            const f64 seconds = stats.nanoseconds * 1e-9;
+
+            AddBenchmarkResult(results, "cache.concurrent", T::GetName(), {
+                { "readerCount", (f64)readerCount },
+                { "lookupsPerSecond", (f64)stats.lookupCount / seconds },
+                { "writesPerSecond", (f64)stats.writeCount / seconds },
+                { "hitRate", stats.lookupCount != 0 ? (f64)stats.hitCount / (f64)stats.lookupCount : 0.0 },
+                { "errorCount", (f64)stats.errorCount }
+            });
+        }
+    }
+
+    template <typename T>
+    static void RunCacheStressBenchmark(cContext* context, std::vector<sBenchmarkResult>& results)
+    {
+        // A tiny live set and index keep the writer reusing elements and replacing the index under the readers
+        usize readerCount = std::thread::hardware_concurrency();
+        readerCount = readerCount > 1 ? readerCount - 1 : 1;
+
+        sChunkAllocatorDescriptor desc;
+        desc.chunkByteSize = 1024;
+        desc.maxChunkCount = 4096;
+        desc.hashTableByteSize = 128;
+
+        const sCacheBenchmarkStats stats = RunCacheWorkload<T>(context, readerCount, 64, 1000000, desc);
+        if (stats.errorCount != 0 || stats.finalCountMismatch != 0)
+            Print("Error: cache stress test of '" + std::string(T::GetName()) + "' saw " + std::to_string(stats.errorCount) + " broken lookups!");
+
+        AddBenchmarkResult(results, "cache.stress", T::GetName(), {
+            { "readerCount", (f64)readerCount },
+            { "lookupCount", (f64)stats.lookupCount },
+            { "writeCount", (f64)stats.writeCount },
+            { "errorCount", (f64)stats.errorCount },
+            { "countMismatch", (f64)stats.finalCountMismatch }
+        });
+    }
+
+    // Churns a live set through a cPool: every round destroys a random actor, creates a replacement in the
+    // freed slot and resolves live and stale handles. Live handles must resolve to their actor, stale ones must miss.
+    static void RunPoolChurnBenchmark(cContext* context, std::vector<sBenchmarkResult>& results)
+    {
+        static constexpr usize K_LIVE_COUNT = 64 * 1024;
+        static constexpr usize K_ROUND_COUNT = 200000;
+        static constexpr usize K_LOOKUP_COUNT = 4;
+
+        cPool<cBenchmarkPoolActor> pool(context, K_LIVE_COUNT, 64);
+        std::vector<cHandle> handles(K_LIVE_COUNT);
+        std::vector<u64> values(K_LIVE_COUNT);
+        for (usize i = 0; i < K_LIVE_COUNT; i++)
+        {
+            values[i] = i;
+            handles[i] = context->Create<cBenchmarkPoolActor>(&pool, context, (u64)i);
+        }
+
+        cBenchmarkRandom random(7);
+        u64 errorCount = 0;
+        u64 checksum = 0;
+
+        cBenchmarkTimer timer;
+        for (usize round = 0; round < K_ROUND_COUNT; round++)
+        {
+            const usize victim = random.Range(K_LIVE_COUNT);
+            const cHandle staleHandle = handles[victim];
+            context->Destroy(&pool, staleHandle);
+            values[victim] = K_LIVE_COUNT + round;
+            handles[victim] = context->Create<cBenchmarkPoolActor>(&pool, context, values[victim]);
+
+            errorCount += pool.Find(staleHandle) != nullptr ? 1 : 0;
+            for (usize i = 0; i < K_LOOKUP_COUNT; i++)
+            {
+                const usize index = random.Range(K_LIVE_COUNT);
+                const cBenchmarkPoolActor* actor = pool.Find(handles[index]);
+                errorCount += actor == nullptr || actor->IsValid(values[index]) == K_FALSE ? 1 : 0;
+            }
+        }
+        const f64 churnNanoseconds = timer.GetNanoseconds();
+
+        cBenchmarkTimer iterationTimer;
+        for (usize i = 0; i < pool.GetElementCount(); i++)
+            checksum += pool.GetElement((u32)i)->GetValue();
+        const f64 iterationNanoseconds = iterationTimer.GetNanoseconds();
+
+        const u64 countMismatch = pool.GetElementCount() != K_LIVE_COUNT ? 1 : 0;
+        if (errorCount != 0 || countMismatch != 0)
+            Print("Error: pool churn saw " + std::to_string(errorCount) + " broken lookups!");
+
+        AddBenchmarkResult(results, "pool.churn", "pool", {
+            { "liveCount", (f64)K_LIVE_COUNT },
+            { "nanosecondsPerRound", churnNanoseconds / (f64)K_ROUND_COUNT },
+            { "nanosecondsPerIteratedElement", iterationNanoseconds / (f64)K_LIVE_COUNT },
+            { "errorCount", (f64)errorCount },
+            { "countMismatch", (f64)countMismatch },
+            { "checksum", (f64)(checksum & 0xFFFF) }
+        });
+    }
+
+    void RunCacheBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results)
+    {
+        if (IsBenchmarkSelected(filter, "cache.concurrent") == K_FALSE && IsBenchmarkSelected(filter, "cache.stress") == K_FALSE &&
+            IsBenchmarkSelected(filter, "pool.churn") == K_FALSE)
+            return;
+
+        sCapabilities caps;
+        cContext context;
+        context.CreateMemoryAllocator(&caps);
+        context.RegisterFactory<cBenchmarkActor>();
+        context.RegisterFactory<cBenchmarkPoolActor>();
+
+        if (IsBenchmarkSelected(filter, "cache.concurrent"))
+        {
+            RunConcurrentCacheBenchmark<cConcurrentCachePolicy>(&context, results);
+            RunConcurrentCacheBenchmark<cSharedMutexPolicy>(&context, results);
+        }
+
+        if (IsBenchmarkSelected(filter, "cache.stress"))
+            RunCacheStressBenchmark<cConcurrentCachePolicy>(&context, results);
+
+        if (IsBenchmarkSelected(filter, "pool.churn"))
+            RunPoolChurnBenchmark(&context, results);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,209 @@
+// hash_benchmarks.cpp
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include "benchmark.hpp"
+#include "../engine/src/hash.hpp"
+#include "../engine/src/tag.hpp"
+
+using namespace types;
+
+namespace triton
+{
+    static constexpr usize K_TAG_KEY_COUNT = 1 << 20;
+    static constexpr usize K_BUCKET_BITS = 16;
+
+    // Literal tags must hash the same at compile time as at runtime, otherwise constexpr tags would miss lookups
+    static constexpr cTag kCompileTimeTag("cGameObject42");
+    static_assert(kCompileTimeTag.GetHash() == cHash::Compute("cGameObject42", 13), "Tag hash isn't constexpr!");
+
+    class cEngineHashPolicy
+    {
+    public:
+        static const char* GetName() { return "engine"; }
+
+        static inline u64 Hash(const u8* data, usize byteSize) { return cHash::ComputeRuntime(data, byteSize); }
+    };
+
+    // The function cMath::Hash used before, with its byte counter fixed so it terminates
+    class cLegacyHashPolicy
+    {
+    public:
+        static const char* GetName() { return "legacy"; }
+
+        static inline u64 Hash(const u8* data, usize byteSize)
+        {
+            u64 hash = 0x9e3779b97f4a7c15ull;
+            while (byteSize >= 4)
+            {
+                hash = (hash ^ (((u64)(*data++) * 0x9e3779b9ull) >> 32)) * 0xbf58476d1ce4e5b9ull;
+                byteSize -= 4;
+            }
+
+            u32 tail = 0;
+            memcpy(&tail, data, byteSize);
+            hash ^= tail;
+
+            return hash;
+        }
+    };
+
+    // Keys shaped like cIdentifier::Generate output: a class name followed by a running counter
+    static std::vector<std::string> MakeTagKeys(usize count)
+    {
+        static const char* typeNames[] = { "cGameObject", "cMaterial", "cPhysicsActor", "cEventHandler", "cTextureAtlasTexture" };
+
+        std::vector<std::string> keys;
+        keys.reserve(count);
+        for (usize i = 0; i < count; i++)
+            keys.push_back(typeNames[i % 5] + std::to_string(i / 5));
+
+        return keys;
+    }
+
+    template <typename T>
+    static void RunThroughputBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        static const usize byteSizes[] = { 4, 8, 16, 24, 32, 64, 256, 4096 };
+
+        cBenchmarkRandom random(1);
+        std::vector<u8> data(64 * 1024);
+        for (usize i = 0; i < data.size(); i++)
+            data[i] = (u8)random.Next();
+
+        for (usize byteSize : byteSizes)
+        {
+            const usize hashCount = (64 * 1024 * 1024) / (byteSize + 16);
+            const usize offsetMask = (data.size() - byteSize) & ~(usize)7;
+
+            u64 checksum = 0;
+            cBenchmarkTimer timer;
+            for (usize i = 0; i < hashCount; i++)
+                checksum += T::Hash(&data[(i * 64) & offsetMask], byteSize);
+            const f64 nanoseconds = timer.GetNanoseconds();
+
+            AddBenchmarkResult(results, "hash.throughput", T::GetName(), {
+                { "byteSize", (f64)byteSize },
+                { "nsPerHash", nanoseconds / (f64)hashCount },
+                { "gbPerSecond", (f64)(byteSize * hashCount) / nanoseconds },
+                { "checksum", (f64)(checksum & 0xFFFF) }
+            });
+        }
+    }
+
+    template <typename T>
+    static void RunTagBenchmark(const std::vector<std::string>& keys, std::vector<sBenchmarkResult>& results)
+    {
+        std::vector<u64> hashes(keys.size());
+
+        cBenchmarkTimer timer;
+        for (usize i = 0; i < keys.size(); i++)
+            hashes[i] = T::Hash((const u8*)keys[i].data(), keys[i].size());
+        const f64 nanoseconds = timer.GetNanoseconds();
+
+        // Chi-square of the low bits over a power-of-two table, which is how cHashTable picks a home slot.
+        // A ratio near 1 means a uniform distribution, much larger means clustering.
+        const usize bucketCount = (usize)1 << K_BUCKET_BITS;
+        std::vector<u32> buckets(bucketCount, 0);
+        for (u64 hash : hashes)
+            buckets[hash & (bucketCount - 1)] += 1;
+
+        const f64 expected = (f64)hashes.size() / (f64)bucketCount;
+        f64 chiSquare = 0.0;
+        usize maxBucket = 0;
+        for (u32 bucket : buckets)
+        {
+            chiSquare += ((f64)bucket - expected) * ((f64)bucket - expected) / expected;
+            if (bucket > maxBucket)
+                maxBucket = bucket;
+        }
+
+        std::unordered_set<u64> fullHashes(hashes.begin(), hashes.end());
+        std::unordered_set<u32> foldedHashes;
+        for (u64 hash : hashes)
+            foldedHashes.insert((u32)(hash ^ (hash >> 32)));
+
+        AddBenchmarkResult(results, "hash.tags", T::GetName(), {
+            { "keyCount", (f64)keys.size() },
+            { "nsPerHash", nanoseconds / (f64)keys.size() },
+            { "bucketChiSquareRatio", chiSquare / (f64)(bucketCount - 1) },
+            { "maxBucketCount", (f64)maxBucket },
+            { "collisions64", (f64)(hashes.size() - fullHashes.size()) },
+            { "collisions32", (f64)(hashes.size() - foldedHashes.size()) }
+        });
+    }
+
+    // SMHasher-style avalanche: flipping any input bit should flip every output bit with probability 0.5
+    template <typename T>
+    static void RunAvalancheBenchmark(std::vector<sBenchmarkResult>& results)
+    {
+        static const usize byteSizes[] = { 8, 16, 32 };
+        static constexpr usize K_SAMPLE_COUNT = 4096;
+
+        cBenchmarkRandom random(7);
+        for (usize byteSize : byteSizes)
+        {
+            const usize inputBitCount = byteSize * 8;
+            std::vector<u32> flips(inputBitCount * 64, 0);
+            u8 key[32] = {};
+
+            for (usize sample = 0; sample < K_SAMPLE_COUNT; sample++)
+            {
+                for (usize i = 0; i < byteSize; i++)
+                    key[i] = (u8)random.Next();
+                const u64 hash = T::Hash(key, byteSize);
+
+                for (usize bit = 0; bit < inputBitCount; bit++)
+                {
+                    key[bit / 8] ^= (u8)(1 << (bit % 8));
+                    u64 difference = hash ^ T::Hash(key, byteSize);
+                    key[bit / 8] ^= (u8)(1 << (bit % 8));
+
+                    for (usize outputBit = 0; difference != 0; outputBit++, difference >>= 1)
+                        flips[bit * 64 + outputBit] += (u32)(difference & 1);
+                }
+            }
+
+            f64 worstBias = 0.0;
+            f64 totalBias = 0.0;
+            for (u32 flipCount : flips)
+            {
+                const f64 bias = (f64)flipCount / (f64)K_SAMPLE_COUNT * 2.0 - 1.0;
+                const f64 absoluteBias = bias < 0.0 ? -bias : bias;
+                totalBias += absoluteBias;
+                if (absoluteBias > worstBias)
+                    worstBias = absoluteBias;
+            }
+
+            AddBenchmarkResult(results, "hash.avalanche", T::GetName(), {
+                { "byteSize", (f64)byteSize },
+                { "worstBias", worstBias },
+                { "meanBias", totalBias / (f64)flips.size() }
+            });
+        }
+    }
+
+    void RunHashBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results)
+    {
+        if (IsBenchmarkSelected(filter, "hash.throughput"))
+        {
+            RunThroughputBenchmark<cEngineHashPolicy>(results);
+            RunThroughputBenchmark<cLegacyHashPolicy>(results);
+        }
+
+        if (IsBenchmarkSelected(filter, "hash.tags"))
+        {
+            const std::vector<std::string> keys = MakeTagKeys(K_TAG_KEY_COUNT);
+            RunTagBenchmark<cEngineHashPolicy>(keys, results);
+            RunTagBenchmark<cLegacyHashPolicy>(keys, results);
+        }
+
+        if (IsBenchmarkSelected(filter, "hash.avalanche"))
+        {
+            RunAvalancheBenchmark<cEngineHashPolicy>(results);
+            RunAvalancheBenchmark<cLegacyHashPolicy>(results);
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,111 @@
+// main.cpp
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+#include "benchmark.hpp"
+#include "../engine/src/log.hpp"
+
+using namespace triton;
+using namespace types;
+
+namespace triton
+{
+    usize GetResidentByteSize()
+    {
+#if defined(_WIN32)
+        PROCESS_MEMORY_COUNTERS counters = {};
+        if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) == 0)
+            return 0;
+
+        return (usize)counters.WorkingSetSize;
+#else
+        FILE* file = fopen("/proc/self/statm", "r");
+        if (file == nullptr)
+            return 0;
+
+        unsigned long long pageCount = 0;
+        unsigned long long residentPageCount = 0;
+        const int count = fscanf(file, "%llu %llu", &pageCount, &residentPageCount);
+        fclose(file);
+        if (count != 2)
+            return 0;
+
+        return (usize)residentPageCount * (usize)sysconf(_SC_PAGESIZE);
+#endif
+    }
+
+    std::string MakeBenchmarkJson(const std::vector<sBenchmarkResult>& results)
+    {
+        std::string json = "[\n";
+        for (usize i = 0; i < results.size(); i++)
+        {
+            const sBenchmarkResult& result = results[i];
+
+            json += "  {\"benchmark\":\"" + result.benchmark + "\",\"variant\":\"" + result.variant + "\"";
+            for (const auto& metric : result.metrics)
+            {
+                char value[64] = {};
+                snprintf(value, sizeof(value), "%.3f", metric.value);
+                json += ",\"" + metric.name + "\":" + value;
+            }
+            json += i + 1 < results.size() ? "},\n" : "}\n";
+        }
+        json += "]\n";
+
+        return json;
+    }
+
+    types::boolean IsBenchmarkSelected(const std::string& filter, const std::string& name)
+    {
+        return filter.empty() || filter == "all" || name.compare(0, filter.size(), filter) == 0 ? K_TRUE : K_FALSE;
+    }
+
+    void AddBenchmarkResult(std::vector<sBenchmarkResult>& results, const std::string& benchmark, const std::string& variant, const std::vector<sBenchmarkMetric>& metrics)
+    {
+        sBenchmarkResult result;
+        result.benchmark = benchmark;
+        result.variant = variant;
+        result.metrics = metrics;
+        results.push_back(result);
+    }
+}
+
+// Usage: RealWareBenchmarks [filter] [output.json]
+// The filter selects benchmarks by name prefix, for example "allocator", "allocator.churn" or "hash"
+int main(int argc, char** argv)
+{
+    const std::string filter = argc > 1 ? argv[1] : "";
+    const std::string outputPath = argc > 2 ? argv[2] : "";
+
+    std::vector<sBenchmarkResult> results;
+    RunAllocatorBenchmarks(filter, results);
+    RunHashBenchmarks(filter, results);
+    RunCacheBenchmarks(filter, results);
+    RunThreadBenchmarks(filter, results);
+
+    const std::string json = MakeBenchmarkJson(results);
+    if (outputPath.empty())
+    {
+        Print(json);
+    }
+    else
+    {
+        std::ofstream outputFile(outputPath);
+        if (!outputFile)
+        {
+            Print("Error: can't open benchmark output file '" + outputPath + "'!");
+            return 1;
+        }
+        outputFile << json;
+    }
+
+    return 0;
+}
\ No newline at end of file
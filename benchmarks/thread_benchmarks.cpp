@@ -0,0 +1,309 @@
+// thread_benchmarks.cpp
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include "benchmark.hpp"
+#include "../engine/src/capabilities.hpp"
+#include "../engine/src/context.hpp"
+#include "../engine/src/thread_manager.hpp"
+
+using namespace types;
+
+namespace triton
+{
+    static constexpr usize K_FRAME_TASK_COUNT = 10000;
+    static constexpr usize K_FRAME_COUNT = 50;
+    static constexpr usize K_NESTED_ROOT_COUNT = 64;
+    static constexpr usize K_NESTED_TASK_COUNT = K_FRAME_TASK_COUNT / K_NESTED_ROOT_COUNT * K_NESTED_ROOT_COUNT;
+    static constexpr usize K_RESUME_ROUND_COUNT = 200;
+    // Scaling runs go at least this wide so races between workers are exercised on small machines too
+    static constexpr usize K_MIN_SCALING_THREAD_COUNT = 4;
+
+    // A few hundred nanoseconds of arithmetic, small enough that scheduling overhead dominates a slow pool
+    static inline u64 RunTinyWork(u64 seed)
+    {
+        u64 value = seed | 1;
+        for (usize i = 0; i < 64; i++)
+        {
+            value ^= value << 13;
+            value ^= value >> 7;
+            value ^= value << 17;
+        }
+
+        return value;
+    }
+
+    // What the checksum of one run must add up to if every task ran exactly once
+    static u64 GetExpectedChecksum(usize taskCountPerFrame)
+    {
+        u64 checksum = 0;
+        for (usize i = 0; i < taskCountPerFrame; i++)
+            checksum += RunTinyWork(i) & 1;
+
+        return checksum * K_FRAME_COUNT;
+    }
+
+    class cWorkStealingPolicy
+    {
+    public:
+        explicit cWorkStealingPolicy(cContext* context, usize threadCount) : _pool(context, threadCount) {}
+
+        static const char* GetName() { return "work_stealing"; }
+
+        template <typename F>
+        inline void Submit(F&& function)
+        {
+            _pool.Submit(nullptr, std::forward<F>(function));
+        }
+
+    private:
+        cThread _pool;
+    };
+
+    // The pool cThread used before: one locked queue, one wakeup per task, each task a shared std::function
+    class cSingleQueuePolicy
+    {
+    public:
+        explicit cSingleQueuePolicy(cContext*, usize threadCount)
+        {
+            for (usize i = 0; i < threadCount; i++)
+            {
+                _threads.emplace_back([this] {
+                    while (K_TRUE)
+                    {
+                        std::shared_ptr<TaskFunction> task;
+                        {
+                            std::unique_lock<std::mutex> lock(_mtx);
+                            _cv.wait(lock, [this] { return !_tasks.empty() || _stop; });
+                            if (_stop && _tasks.empty())
+                                return;
+                            task = std::move(_tasks.front());
+                            _tasks.pop();
+                        }
+                        (*task)(nullptr);
+                    }
+                });
+            }
+        }
+
+        ~cSingleQueuePolicy()
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mtx);
+                _stop = K_TRUE;
+            }
+            _cv.notify_all();
+            for (auto& thread : _threads)
+                thread.join();
+        }
+
+        static const char* GetName() { return "single_queue"; }
+
+        template <typename F>
+        inline void Submit(F&& function)
+        {
+            std::shared_ptr<TaskFunction> task = std::make_shared<TaskFunction>(std::forward<F>(function));
+            {
+                std::unique_lock<std::mutex> lock(_mtx);
+                _tasks.push(std::move(task));
+            }
+            _cv.notify_one();
+        }
+
+    private:
+        std::vector<std::thread> _threads;
+        std::queue<std::shared_ptr<TaskFunction>> _tasks;
+        std::mutex _mtx;
+        std::condition_variable _cv;
+        types::boolean _stop = K_FALSE;
+    };
+
+    static void WaitForTasks(const std::atomic<usize>& doneCount, usize taskCount)
+    {
+        while (doneCount.load(std::memory_order_acquire) < taskCount)
+            std::this_thread::yield();
+    }
+
+    // Every frame the main thread submits K_FRAME_TASK_COUNT tiny tasks and waits for all of them
+    template <typename T>
+    static f64 RunFlatFrames(cContext* context, usize threadCount, std::atomic<u64>& checksum)
+    {
+        T pool(context, threadCount);
+        std::atomic<usize> doneCount = { 0 };
+
+        cBenchmarkTimer timer;
+        for (usize frame = 0; frame < K_FRAME_COUNT; frame++)
+        {
+            doneCount.store(0, std::memory_order_relaxed);
+            for (usize i = 0; i < K_FRAME_TASK_COUNT; i++)
+            {
+                pool.Submit([&checksum, &doneCount, i](cBuffer* const) {
+                    checksum.fetch_add(RunTinyWork(i) & 1, std::memory_order_relaxed);
+                    doneCount.fetch_add(1, std::memory_order_release);
+                });
+            }
+            WaitForTasks(doneCount, K_FRAME_TASK_COUNT);
+        }
+
+        return timer.GetNanoseconds();
+    }
+
+    // Every frame a few root tasks fan out the frame's tasks from inside the pool, the pattern local deques serve
+    template <typename T>
+    static f64 RunNestedFrames(cContext* context, usize threadCount, std::atomic<u64>& checksum)
+    {
+        T pool(context, threadCount);
+        std::atomic<usize> doneCount = { 0 };
+        const usize childCount = K_NESTED_TASK_COUNT / K_NESTED_ROOT_COUNT;
+        const usize taskCount = K_NESTED_TASK_COUNT;
+
+        cBenchmarkTimer timer;
+        for (usize frame = 0; frame < K_FRAME_COUNT; frame++)
+        {
+            doneCount.store(0, std::memory_order_relaxed);
+            for (usize root = 0; root < K_NESTED_ROOT_COUNT; root++)
+            {
+                pool.Submit([&pool, &checksum, &doneCount, root, childCount](cBuffer* const) {
+                    for (usize i = 0; i < childCount; i++)
+                    {
+                        const usize seed = root * childCount + i;
+                        pool.Submit([&checksum, &doneCount, seed](cBuffer* const) {
+                            checksum.fetch_add(RunTinyWork(seed) & 1, std::memory_order_relaxed);
+                            doneCount.fetch_add(1, std::memory_order_release);
+                        });
+                    }
+                });
+            }
+            WaitForTasks(doneCount, taskCount);
+        }
+
+        return timer.GetNanoseconds();
+    }
+
+    template <typename T>
+    static void RunSchedulerBenchmark(cContext* context, const std::string& name, f64 (*runFrames)(cContext*, usize, std::atomic<u64>&), usize taskCountPerFrame, std::vector<sBenchmarkResult>& results)
+    {
+        usize maxThreadCount = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        if (maxThreadCount < K_MIN_SCALING_THREAD_COUNT)
+            maxThreadCount = K_MIN_SCALING_THREAD_COUNT;
+        const u64 expectedChecksum = GetExpectedChecksum(taskCountPerFrame);
+
+        std::vector<usize> threadCounts;
+        for (usize threadCount = 1; threadCount < maxThreadCount; threadCount *= 2)
+            threadCounts.push_back(threadCount);
+        threadCounts.push_back(maxThreadCount);
+
+        f64 singleThreadNanoseconds = 0.0;
+        for (const usize threadCount : threadCounts)
+        {
+            std::atomic<u64> checksum = { 0 };
+            const f64 nanoseconds = runFrames(context, threadCount, checksum);
+            if (threadCount == 1)
+                singleThreadNanoseconds = nanoseconds;
+
+            const f64 taskCount = (f64)(K_FRAME_COUNT * taskCountPerFrame);
+            AddBenchmarkResult(results, name, T::GetName(), {
+                { "threadCount", (f64)threadCount },
+                { "tasksPerSecond", taskCount / (nanoseconds * 1e-9) },
+                { "nanosecondsPerFrame", nanoseconds / (f64)K_FRAME_COUNT },
+                { "speedup", singleThreadNanoseconds / nanoseconds },
+                { "errorCount", checksum.load(std::memory_order_relaxed) != expectedChecksum ? 1.0 : 0.0 }
+            });
+        }
+    }
+
+    static inline s64 GetSteadyNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Pauses the pool with a task pending, then measures how long Resume takes to get it running,
+    // and how the workers split their idle time between spinning and parking meanwhile
+    static void RunResumeBenchmark(cContext* context, const char* variant, u32 spinCount, std::vector<sBenchmarkResult>& results)
+    {
+        const usize threadCount = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+        cThread pool(context, threadCount);
+        pool.SetSpinCount(spinCount);
+        pool.ResetWorkerStats();
+
+        f64 resumeNanoseconds = 0.0;
+        f64 maxResumeNanoseconds = 0.0;
+        cBenchmarkTimer timer;
+        for (usize round = 0; round < K_RESUME_ROUND_COUNT; round++)
+        {
+            std::atomic<s64> startNanoseconds = { 0 };
+
+            pool.Pause();
+            pool.Submit(nullptr, [&startNanoseconds](cBuffer* const) {
+                startNanoseconds.store(GetSteadyNanoseconds(), std::memory_order_release);
+            });
+            std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+            const s64 resumeStart = GetSteadyNanoseconds();
+            pool.Resume();
+            while (startNanoseconds.load(std::memory_order_acquire) == 0)
+                std::this_thread::yield();
+
+            const f64 latency = (f64)(startNanoseconds.load(std::memory_order_relaxed) - resumeStart);
+            resumeNanoseconds += latency;
+            if (latency > maxResumeNanoseconds)
+                maxResumeNanoseconds = latency;
+        }
+        const f64 elapsedNanoseconds = timer.GetNanoseconds();
+
+        f64 spinNanoseconds = 0.0;
+        f64 parkedNanoseconds = 0.0;
+        f64 parkCount = 0.0;
+        for (usize i = 0; i < pool.GetThreadCount(); i++)
+        {
+            const sThreadWorkerStats stats = pool.GetWorkerStats(i);
+            spinNanoseconds += (f64)stats.spinNanoseconds;
+            parkedNanoseconds += (f64)stats.parkedNanoseconds;
+            parkCount += (f64)stats.parkCount;
+        }
+
+        AddBenchmarkResult(results, "scheduler.resume", variant, {
+            { "threadCount", (f64)threadCount },
+            { "nanosecondsPerResume", resumeNanoseconds / (f64)K_RESUME_ROUND_COUNT },
+            { "maxNanosecondsPerResume", maxResumeNanoseconds },
+            { "spinShare", spinNanoseconds / (elapsedNanoseconds * (f64)threadCount) },
+            { "parkedShare", parkedNanoseconds / (elapsedNanoseconds * (f64)threadCount) },
+            { "parksPerWorker", parkCount / (f64)threadCount }
+        });
+    }
+
+    void RunThreadBenchmarks(const std::string& filter, std::vector<sBenchmarkResult>& results)
+    {
+        if (IsBenchmarkSelected(filter, "scheduler.flat") == K_FALSE && IsBenchmarkSelected(filter, "scheduler.nested") == K_FALSE &&
+            IsBenchmarkSelected(filter, "scheduler.resume") == K_FALSE)
+            return;
+
+        sCapabilities caps;
+        cContext context;
+        context.CreateMemoryAllocator(&caps);
+
+        if (IsBenchmarkSelected(filter, "scheduler.flat"))
+        {
+            RunSchedulerBenchmark<cWorkStealingPolicy>(&context, "scheduler.flat", &RunFlatFrames<cWorkStealingPolicy>, K_FRAME_TASK_COUNT, results);
+            RunSchedulerBenchmark<cSingleQueuePolicy>(&context, "scheduler.flat", &RunFlatFrames<cSingleQueuePolicy>, K_FRAME_TASK_COUNT, results);
+        }
+
+        if (IsBenchmarkSelected(filter, "scheduler.nested"))
+        {
+            RunSchedulerBenchmark<cWorkStealingPolicy>(&context, "scheduler.nested", &RunNestedFrames<cWorkStealingPolicy>, K_NESTED_TASK_COUNT, results);
+            RunSchedulerBenchmark<cSingleQueuePolicy>(&context, "scheduler.nested", &RunNestedFrames<cSingleQueuePolicy>, K_NESTED_TASK_COUNT, results);
+        }
+
+        if (IsBenchmarkSelected(filter, "scheduler.resume"))
+        {
+            RunResumeBenchmark(&context, "spin_then_park", cThread::K_DEFAULT_SPIN_COUNT, results);
+            RunResumeBenchmark(&context, "park", 0, results);
+        }
+    }
+}
\ No newline at end of file
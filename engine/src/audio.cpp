@@ -59,7 +59,7 @@ namespace triton
 			// Data
 			const usize numSamples = wav._subchunk2Size / (_channelCount * (_bitsPerSample / 8));
 			_dataByteSize = numSamples * (_bitsPerSample / 8) * _channelCount;
-			_data = (u16*)memoryAllocator->Allocate(_dataByteSize, caps->memoryAlignment);
+			_data = (u16*)memoryAllocator->Allocate(_dataByteSize, caps->memoryAlignment, eMemoryBudget::AUDIO);
 			if (_bitsPerSample == 16 && _channelCount == 2)
 			{
 				for (usize i = 0; i < numSamples; i++)
@@ -78,7 +78,7 @@ namespace triton
 	cSound::~cSound()
 	{
 		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
-		memoryAllocator->Deallocate(_data);
+		memoryAllocator->Deallocate(_data, eMemoryBudget::AUDIO);
 		_audioBackend->Destroy(this);
 	}
 
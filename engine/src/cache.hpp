@@ -18,24 +18,42 @@ namespace triton
 
 	public:
 		explicit cCache(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc);
-		virtual ~cCache() override final = default;
+		virtual ~cCache() override final;
 
 		template <typename... Args>
 		cCacheObject<T> Create(Args&&... args);
-		cCacheObject<T> Find(const cTag& idStr);
-		void Destroy(const cTag& idStr);
+		template <typename... Args>
+		types::usize CreateBatch(types::usize count, T** objects, const Args&... args);
+		cCacheObject<T> Find(const cTag& id);
+		void Destroy(const cTag& id);
+		void DestroyBatch(const cTag* ids, types::usize count);
+
+		template <typename C>
+		inline types::u32 AddColumn(C (*read)(const T& object)) { return _objects->AddColumn(read); }
+		inline void RefreshColumns(const cTag& id) { _objects->RefreshColumns(id); }
+		template <typename C>
+		inline sHashTableColumnSpan<C> GetColumn(types::u32 column, types::u32 chunkIndex) const { return _objects->template GetColumn<C>(column, chunkIndex); }
+		inline types::boolean Save(const std::string& path) const { return _objects->Save(path); }
+		inline types::boolean Restore(const std::string& path, const T& prototype) { return _objects->Restore(path, prototype); }
 
 		inline T* GetElement(types::u32 index) const { return _objects->GetElement(index); }
 		inline types::usize GetElementCount() const { return _objects->GetElementCount(); }
+		inline types::usize GetChunkCount() const { return _objects->GetChunkCount(); }
 
 	private:
-		cCache<T>* _objects = nullptr;
+		cHashTable<T>* _objects = nullptr;
 	};
 
 	template <typename T>
 	cCache<T>::cCache(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc) : iObject(context)
 	{
-		_objects = _context->Create<cCache<T>>(_context, allocatorDesc);
+		_objects = _context->Create<cHashTable<T>>(_context, allocatorDesc);
+	}
+
+	template <typename T>
+	cCache<T>::~cCache()
+	{
+		_context->Destroy<cHashTable<T>>(_objects);
 	}
 
 	template <typename T>
@@ -49,14 +67,30 @@ namespace triton
 	}
 
 	template <typename T>
-	cCacheObject<T> cCache<T>::Find(const cTag& idStr)
+	template <typename... Args>
+	types::usize cCache<T>::CreateBatch(types::usize count, T** objects, const Args&... args)
+	{
+		return _objects->InsertBatch(count, objects, args...);
+	}
+
+	template <typename T>
+	cCacheObject<T> cCache<T>::Find(const cTag& id)
 	{
-		return _objects->Find(id);
+		cCacheObject<T> co = {};
+		co.object = _objects->Find(id);
+
+		return co;
 	}
 
 	template <typename T>
-	void cCache<T>::Destroy(const cTag& idStr)
+	void cCache<T>::Destroy(const cTag& id)
 	{
 		_objects->Erase(id);
 	}
+
+	template <typename T>
+	void cCache<T>::DestroyBatch(const cTag* ids, types::usize count)
+	{
+		_objects->EraseBatch(ids, count);
+	}
 }
\ No newline at end of file
@@ -9,6 +9,20 @@ namespace triton
         types::usize windowHeight = 480;
         types::boolean fullscreen = types::K_FALSE;
         types::usize memoryAlignment = 64;
+        types::usize memorySlabByteSize = 64 * 1024;
+        types::usize memoryMaxSlabCount = 4096;
+        types::usize memoryHighWaterMarkByteSize = 32 * 1024 * 1024;
+        types::boolean memoryHugePages = types::K_FALSE;
+        types::usize memoryFrameByteSize = 4 * 1024 * 1024;
+        types::usize memoryFrameCount = 2;
+        types::usize memoryStackByteSize = 1024 * 1024;
+        types::usize memoryRenderStagingBudgetByteSize = 256 * 1024 * 1024;
+        types::usize memoryAudioBudgetByteSize = 128 * 1024 * 1024;
+        types::usize memoryPhysicsBudgetByteSize = 128 * 1024 * 1024;
+        types::usize memoryFontBudgetByteSize = 16 * 1024 * 1024;
+        types::usize memoryGameObjectBudgetByteSize = 64 * 1024 * 1024;
+        types::f32 memoryBudgetSoftLimit = 0.8f;
+        types::boolean memoryBudgetAbortOnHardLimit = types::K_FALSE;
         types::usize maxPhysicsSceneCount = 16;
         types::usize maxPhysicsMaterialCount = 256;
         types::usize maxPhysicsActorCount = 8192;
@@ -23,5 +37,6 @@ namespace triton
         types::usize maxRenderTextureAtlasTextureCount = 8192;
         types::usize vertexBufferSize = 64 * 1024 * 1024;
         types::usize indexBufferSize = 64 * 1024 * 1024;
+        types::usize geometryDefragmentationByteSize = 0;
     };
 }
\ No newline at end of file
@@ -0,0 +1,362 @@
+// concurrent_cache.hpp
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <utility>
+#include "object.hpp"
+#include "context.hpp"
+#include "epoch_domain.hpp"
+#include "hash_table.hpp"
+#include "memory_pool.hpp"
+#include "types.hpp"
+
+namespace triton
+{
+	struct sConcurrentCacheIndex
+	{
+		types::usize slotCount = 0;
+		types::u32 slotMask = 0;
+		types::usize usedSlotCount = 0;
+		std::atomic<types::u64>* slots = nullptr;
+	};
+
+	struct sConcurrentCacheRetired
+	{
+		types::u64 epoch = 0;
+		types::u32 element = 0;
+		sConcurrentCacheIndex* index = nullptr;
+	};
+
+	// Read-mostly variant of cCache for lookups from worker threads while the owning thread mutates it.
+	// Find is lock-free and must run inside a cEpochReadScope on GetEpochDomain(), the returned pointer
+	// stays valid until that scope ends. Create and Destroy are serialized by a mutex. Elements never
+	// move, erased elements and replaced indices are destroyed only after every reader that could see
+	// them has left its scope.
+	template <typename T>
+	class cConcurrentCache : public iObject
+	{
+		TRITON_OBJECT(cConcurrentCache)
+
+	public:
+		static constexpr types::usize K_CACHE_LINE_BYTE_SIZE = 64;
+		static constexpr types::u64 K_EMPTY_SLOT = 0;
+		static constexpr types::u64 K_ERASED_SLOT = 1;
+		static constexpr types::u32 K_INVALID_ELEMENT = 0xFFFFFFFF;
+		static constexpr types::usize K_RECLAIM_BATCH_COUNT = 64;
+
+	public:
+		explicit cConcurrentCache(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc);
+		virtual ~cConcurrentCache() override final;
+
+		template <typename... Args>
+		T* Create(Args&&... args);
+		T* Find(const cTag& id) const;
+		void Destroy(const cTag& id);
+		void Reclaim();
+
+		inline cEpochDomain* GetEpochDomain() const { return &_epochDomain; }
+		inline types::usize GetElementCount() const { return _elementCount.load(std::memory_order_relaxed); }
+
+	private:
+		inline T* GetElementPtr(types::u32 element) const { return &_chunks[element / _objectCountPerChunk][element % _objectCountPerChunk]; }
+		static types::u32 MakeHash(const cTag& id);
+		types::u32 AllocateElement();
+		sConcurrentCacheIndex* AllocateIndex(types::usize slotCount);
+		void DeallocateIndex(sConcurrentCacheIndex* index);
+		void InsertSlot(sConcurrentCacheIndex* index, types::u64 entry);
+		void GrowIndex();
+		void ReclaimRetired();
+
+	private:
+		sChunkAllocatorDescriptor _allocatorDesc = {};
+		types::usize _objectCountPerChunk = 0;
+		types::usize _chunkCount = 0;
+		types::u32 _elementEnd = 0;
+		T** _chunks = nullptr;
+		std::atomic<sConcurrentCacheIndex*> _index = { nullptr };
+		std::atomic<types::usize> _elementCount = { 0 };
+		std::vector<types::u32> _freeElements;
+		std::vector<sConcurrentCacheRetired> _retired;
+		mutable cEpochDomain _epochDomain;
+		std::mutex _mutex;
+	};
+
+	template <typename T>
+	cConcurrentCache<T>::cConcurrentCache(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc) : iObject(context)
+	{
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		_allocatorDesc = allocatorDesc;
+		_objectCountPerChunk = _allocatorDesc.chunkByteSize / sizeof(T);
+		_chunks = (T**)memoryAllocator->Allocate(_allocatorDesc.maxChunkCount * sizeof(T*), K_CACHE_LINE_BYTE_SIZE);
+
+		types::usize slotCount = 16;
+		while (slotCount * sizeof(types::u64) < _allocatorDesc.hashTableByteSize)
+			slotCount *= 2;
+		_index.store(AllocateIndex(slotCount), std::memory_order_release);
+	}
+
+	template <typename T>
+	cConcurrentCache<T>::~cConcurrentCache()
+	{
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		// Readers must be gone by now, so everything retired can go regardless of epochs
+		for (const sConcurrentCacheRetired& retired : _retired)
+		{
+			if (retired.index != nullptr)
+				DeallocateIndex(retired.index);
+			else
+				_context->DestroyInPlace(GetElementPtr(retired.element));
+		}
+
+		sConcurrentCacheIndex* index = _index.load(std::memory_order_acquire);
+		for (types::usize i = 0; i < index->slotCount; i++)
+		{
+			const types::u64 entry = index->slots[i].load(std::memory_order_relaxed);
+			if (entry != K_EMPTY_SLOT && entry != K_ERASED_SLOT)
+				_context->DestroyInPlace(GetElementPtr((types::u32)entry));
+		}
+		DeallocateIndex(index);
+
+		for (types::usize i = 0; i < _chunkCount; i++)
+			memoryAllocator->Deallocate(_chunks[i]);
+		memoryAllocator->Deallocate(_chunks);
+	}
+
+	template <typename T>
+	template <typename... Args>
+	T* cConcurrentCache<T>::Create(Args&&... args)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		// Scanning reader epochs costs a pass over every thread slot, so writers only do it per batch
+		if (_retired.size() >= K_RECLAIM_BATCH_COUNT)
+			ReclaimRetired();
+
+		const types::u32 element = AllocateElement();
+		if (element == K_INVALID_ELEMENT)
+		{
+			Print("Error: concurrent cache of type '" + std::string(T::GetTypeNameStatic()) + "' is full!");
+			return nullptr;
+		}
+
+		const types::u32 chunkIndex = element / (types::u32)_objectCountPerChunk;
+		const types::u32 localIndex = element % (types::u32)_objectCountPerChunk;
+		T* object = _context->Create<T>((types::u8*)_chunks[chunkIndex], localIndex, std::forward<Args>(args)...);
+
+		sConcurrentCacheIndex* index = _index.load(std::memory_order_relaxed);
+		if ((index->usedSlotCount + 1) * 8 > index->slotCount * 7)
+		{
+			GrowIndex();
+			index = _index.load(std::memory_order_relaxed);
+		}
+
+		// The release store publishes the constructed object together with its slot
+		InsertSlot(index, ((types::u64)MakeHash(object->GetID()) << 32) | element);
+		_elementCount.fetch_add(1, std::memory_order_relaxed);
+
+		return object;
+	}
+
+	template <typename T>
+	T* cConcurrentCache<T>::Find(const cTag& id) const
+	{
+		const types::u32 hash = MakeHash(id);
+		const sConcurrentCacheIndex* index = _index.load(std::memory_order_acquire);
+
+		types::u32 slot = hash & index->slotMask;
+		for (types::usize i = 0; i < index->slotCount; i++)
+		{
+			const types::u64 entry = index->slots[slot].load(std::memory_order_acquire);
+			if (entry == K_EMPTY_SLOT)
+				return nullptr;
+
+			if ((types::u32)(entry >> 32) == hash)
+			{
+				T* object = GetElementPtr((types::u32)entry);
+				if (object->GetID() == id)
+					return object;
+			}
+
+			slot = (slot + 1) & index->slotMask;
+		}
+
+		return nullptr;
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::Destroy(const cTag& id)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const types::u32 hash = MakeHash(id);
+		sConcurrentCacheIndex* index = _index.load(std::memory_order_relaxed);
+
+		types::u32 slot = hash & index->slotMask;
+		for (types::usize i = 0; i < index->slotCount; i++)
+		{
+			const types::u64 entry = index->slots[slot].load(std::memory_order_relaxed);
+			if (entry == K_EMPTY_SLOT)
+				break;
+
+			if ((types::u32)(entry >> 32) == hash && GetElementPtr((types::u32)entry)->GetID() == id)
+			{
+				// The erased marker keeps probe chains intact for readers already walking past this slot
+				index->slots[slot].store(K_ERASED_SLOT, std::memory_order_release);
+				_elementCount.fetch_sub(1, std::memory_order_relaxed);
+
+				sConcurrentCacheRetired retired;
+				retired.epoch = _epochDomain.Retire();
+				retired.element = (types::u32)entry;
+				_retired.push_back(retired);
+				break;
+			}
+
+			slot = (slot + 1) & index->slotMask;
+		}
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::Reclaim()
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		ReclaimRetired();
+	}
+
+	template <typename T>
+	types::u32 cConcurrentCache<T>::MakeHash(const cTag& id)
+	{
+		const types::u64 hash = id.GetHash();
+		const types::u32 foldedHash = (types::u32)(hash ^ (hash >> 32));
+
+		return foldedHash != 0 ? foldedHash : 1;
+	}
+
+	template <typename T>
+	types::u32 cConcurrentCache<T>::AllocateElement()
+	{
+		if (!_freeElements.empty())
+		{
+			const types::u32 element = _freeElements.back();
+			_freeElements.pop_back();
+
+			return element;
+		}
+
+		if (_elementEnd >= _chunkCount * _objectCountPerChunk)
+		{
+			if (_chunkCount >= _allocatorDesc.maxChunkCount)
+				return K_INVALID_ELEMENT;
+
+			cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+			_chunks[_chunkCount] = (T*)memoryAllocator->Allocate(_allocatorDesc.chunkByteSize, K_CACHE_LINE_BYTE_SIZE);
+			_chunkCount += 1;
+		}
+
+		return _elementEnd++;
+	}
+
+	template <typename T>
+	sConcurrentCacheIndex* cConcurrentCache<T>::AllocateIndex(types::usize slotCount)
+	{
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		sConcurrentCacheIndex* index = (sConcurrentCacheIndex*)memoryAllocator->Allocate(sizeof(sConcurrentCacheIndex), K_CACHE_LINE_BYTE_SIZE);
+		new (index) sConcurrentCacheIndex();
+		index->slotCount = slotCount;
+		index->slotMask = (types::u32)(slotCount - 1);
+		index->slots = (std::atomic<types::u64>*)memoryAllocator->Allocate(slotCount * sizeof(std::atomic<types::u64>), K_CACHE_LINE_BYTE_SIZE);
+		for (types::usize i = 0; i < slotCount; i++)
+			new (&index->slots[i]) std::atomic<types::u64>(K_EMPTY_SLOT);
+
+		return index;
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::DeallocateIndex(sConcurrentCacheIndex* index)
+	{
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		memoryAllocator->Deallocate(index->slots);
+		memoryAllocator->Deallocate(index);
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::InsertSlot(sConcurrentCacheIndex* index, types::u64 entry)
+	{
+		types::u32 slot = (types::u32)(entry >> 32) & index->slotMask;
+		while (true)
+		{
+			const types::u64 current = index->slots[slot].load(std::memory_order_relaxed);
+			if (current == K_EMPTY_SLOT || current == K_ERASED_SLOT)
+			{
+				if (current == K_EMPTY_SLOT)
+					index->usedSlotCount += 1;
+				index->slots[slot].store(entry, std::memory_order_release);
+				return;
+			}
+
+			slot = (slot + 1) & index->slotMask;
+		}
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::GrowIndex()
+	{
+		sConcurrentCacheIndex* oldIndex = _index.load(std::memory_order_relaxed);
+
+		// Rebuilding also drops erased markers, so only grow when live entries need the room
+		types::usize slotCount = oldIndex->slotCount;
+		if ((_elementCount.load(std::memory_order_relaxed) + 1) * 2 > slotCount)
+			slotCount *= 2;
+
+		sConcurrentCacheIndex* index = AllocateIndex(slotCount);
+		for (types::usize i = 0; i < oldIndex->slotCount; i++)
+		{
+			const types::u64 entry = oldIndex->slots[i].load(std::memory_order_relaxed);
+			if (entry != K_EMPTY_SLOT && entry != K_ERASED_SLOT)
+				InsertSlot(index, entry);
+		}
+		_index.store(index, std::memory_order_release);
+
+		sConcurrentCacheRetired retired;
+		retired.epoch = _epochDomain.Retire();
+		retired.index = oldIndex;
+		_retired.push_back(retired);
+	}
+
+	template <typename T>
+	void cConcurrentCache<T>::ReclaimRetired()
+	{
+		if (_retired.empty())
+			return;
+
+		const types::u64 minReaderEpoch = _epochDomain.GetMinReaderEpoch();
+
+		types::usize keptCount = 0;
+		for (types::usize i = 0; i < _retired.size(); i++)
+		{
+			const sConcurrentCacheRetired& retired = _retired[i];
+			if (_epochDomain.IsReclaimable(retired.epoch, minReaderEpoch) == types::K_FALSE)
+			{
+				_retired[keptCount++] = retired;
+				continue;
+			}
+
+			if (retired.index != nullptr)
+			{
+				DeallocateIndex(retired.index);
+			}
+			else
+			{
+				_context->DestroyInPlace(GetElementPtr(retired.element));
+				_freeElements.push_back(retired.element);
+			}
+		}
+		_retired.resize(keptCount);
+	}
+}
\ No newline at end of file
@@ -3,20 +3,69 @@
 #include "context.hpp"
 #include "memory_pool.hpp"
 #include "render_context.hpp"
+#include "event_manager.hpp"
+#include "buffer.hpp"
 
 namespace triton
 {
-	void cContext::CreateMemoryAllocator()
+	cContext::~cContext()
 	{
+		for (types::usize i = 0; i < cTypeRegistry::MAX_TYPE_COUNT; i++)
+			delete _factories[i];
+
+		// The frame allocator returns its buffers to the memory allocator, which goes last and reports leaks
+		delete _frameAllocator;
+		delete _allocator;
+	}
+
+	void cContext::CreateMemoryAllocator(const sCapabilities* caps)
+	{
+		_capabilities = caps;
+
+		sMemoryAllocatorDescriptor desc;
+		desc.slabByteSize = caps->memorySlabByteSize;
+		desc.maxSlabCount = caps->memoryMaxSlabCount;
+		desc.highWaterMarkByteSize = caps->memoryHighWaterMarkByteSize;
+		desc.hugePages = caps->memoryHugePages;
+		desc.budgetByteSizes[(types::usize)eMemoryBudget::RENDER_STAGING] = caps->memoryRenderStagingBudgetByteSize;
+		desc.budgetByteSizes[(types::usize)eMemoryBudget::AUDIO] = caps->memoryAudioBudgetByteSize;
+		desc.budgetByteSizes[(types::usize)eMemoryBudget::PHYSICS] = caps->memoryPhysicsBudgetByteSize;
+		desc.budgetByteSizes[(types::usize)eMemoryBudget::FONT] = caps->memoryFontBudgetByteSize;
+		desc.budgetByteSizes[(types::usize)eMemoryBudget::GAME_OBJECT] = caps->memoryGameObjectBudgetByteSize;
+		desc.budgetSoftLimit = caps->memoryBudgetSoftLimit;
+		desc.budgetAbortOnHardLimit = caps->memoryBudgetAbortOnHardLimit;
+
 		_allocator = new cMemoryAllocator();
-		_allocator->SetBins(65536);
+		_allocator->SetBins(desc);
+
+		_frameAllocator = new cFrameAllocator(_allocator, caps->memoryFrameByteSize, caps->memoryFrameCount, caps->memoryStackByteSize);
+	}
+
+	void* cContext::AllocateFrame(types::usize byteSize, types::usize alignment)
+	{
+		return _frameAllocator->Allocate(byteSize, alignment);
+	}
+
+	void cContext::DispatchMemoryBudgetEvents()
+	{
+		cEventDispatcher* eventDispatcher = GetSubsystem<cEventDispatcher>();
+
+		for (types::usize i = 1; i < sMemoryAllocatorDescriptor::MAX_BUDGET_COUNT; i++)
+		{
+			const eMemoryBudget budget = (eMemoryBudget)i;
+			if (_allocator->ConsumeBudgetSoftLimit(budget) == types::K_FALSE)
+				continue;
+
+			sMemoryBudgetReport report = _allocator->GetBudgetReport(budget);
+			cDataBuffer data(this);
+			data.Create(&report, sizeof(report));
+
+			eventDispatcher->Send(eEventType::MEMORY_BUDGET_SOFT_LIMIT, &data);
+		}
 	}
 
-	void cContext::RegisterSubsystem(iObject* object)
+	cLinearAllocator* cContext::GetStackAllocator() const
 	{
-		ClassType type = object->GetType();
-		const auto it = _subsystems.find(type);
-		if (it == _subsystems.end())
-			_subsystems.insert({ type, std::make_shared<iObject>(this) });
+		return _frameAllocator->GetStack();
 	}
 }
\ No newline at end of file
@@ -2,20 +2,25 @@
 
 #pragma once
 
-#include <unordered_map>
 #include "object.hpp"
 #include "factory.hpp"
+#include "handle.hpp"
 #include "types.hpp"
 
 namespace triton
 {
 	class cMemoryAllocator;
+	class cFrameAllocator;
+	class cLinearAllocator;
+	struct sCapabilities;
 
+	// Subsystems and factories are stored in flat arrays indexed by cTypeIndex<T>::value,
+	// so a lookup is an array load with no string building or hashing.
 	class cContext
 	{
 	public:
 		explicit cContext() = default;
-		~cContext() = default;
+		~cContext();
 
 		template <typename T, typename... Args>
 		T* Create(Args&&... args);
@@ -23,17 +28,44 @@ namespace triton
 		template <typename T, typename... Args>
 		T* Create(types::u8* ptr, types::u32 index, Args&&... args);
 
+		template <typename T, typename... Args>
+		T* CreateBatch(types::u8* ptr, types::u32 index, types::usize count, const Args&... args);
+
+		template <typename T, typename... Args>
+		cHandle Create(cPool<T>* pool, Args&&... args);
+
 		template <typename T>
 		void Destroy(T* object);
 
-		void CreateMemoryAllocator();
+		template <typename T>
+		void Destroy(cPool<T>* pool, const cHandle& handle);
+
+		// For objects living in container storage the container owns, the factory records
+		// the adoption, destruction or move so type reports and leak tracking stay correct
+		template <typename T>
+		void Adopt(T* object);
+
+		template <typename T>
+		void DestroyInPlace(T* object);
+
+		template <typename T>
+		void Relocate(T* destination, T* source);
+
+		void CreateMemoryAllocator(const sCapabilities* caps);
+
+		void* AllocateFrame(types::usize byteSize, types::usize alignment);
+		void DispatchMemoryBudgetEvents();
 
 		template <typename T>
 		void RegisterFactory();
 
-		void RegisterSubsystem(iObject* object);
+		template <typename T>
+		void RegisterSubsystem(T* object);
 
+		inline const sCapabilities* GetCapabilities() const { return _capabilities; }
 		inline cMemoryAllocator* GetMemoryAllocator() const { return _allocator; }
+		inline cFrameAllocator* GetFrameAllocator() const { return _frameAllocator; }
+		cLinearAllocator* GetStackAllocator() const;
 
 		template <typename T>
 		inline T* GetFactory() const;
@@ -42,18 +74,19 @@ namespace triton
 		inline T* GetSubsystem() const;
 
 	private:
+		const sCapabilities* _capabilities = nullptr;
 		cMemoryAllocator* _allocator = nullptr;
-		std::unordered_map<ClassType, std::shared_ptr<iObject>> _factories;
-		std::unordered_map<ClassType, std::shared_ptr<iObject>> _subsystems;
+		cFrameAllocator* _frameAllocator = nullptr;
+		iObject* _factories[cTypeRegistry::MAX_TYPE_COUNT] = {};
+		iObject* _subsystems[cTypeRegistry::MAX_TYPE_COUNT] = {};
 	};
 
 	template <typename T, typename... Args>
 	T* cContext::Create(Args&&... args)
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _factories.find(type);
-		if (it != _factories.end())
-			return ((cFactory<T>*)it->second.get())->Create(std::forward<Args>(args)...);
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			return (T*)factory->Create(std::forward<Args>(args)...).object;
 		else
 			return nullptr;
 	}
@@ -61,51 +94,113 @@ namespace triton
 	template <typename T, typename... Args>
 	T* cContext::Create(types::u8* ptr, types::u32 index, Args&&... args)
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _factories.find(type);
-		if (it != _factories.end())
-			return ((cFactory<T>*)it->second.get())->Create(ptr, index, std::forward<Args>(args)...);
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			return (T*)factory->Create(ptr, index, std::forward<Args>(args)...).object;
+		else
+			return nullptr;
+	}
+
+	template <typename T, typename... Args>
+	T* cContext::CreateBatch(types::u8* ptr, types::u32 index, types::usize count, const Args&... args)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			return factory->CreateBatch(ptr, index, count, args...);
 		else
 			return nullptr;
 	}
 
+	template <typename T, typename... Args>
+	cHandle cContext::Create(cPool<T>* pool, Args&&... args)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			return factory->Create(pool, std::forward<Args>(args)...);
+		else
+			return cHandle();
+	}
+
 	template <typename T>
 	void cContext::Destroy(T* object)
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _factories.find(type);
-		if (it != _factories.end())
-			((cFactory<T>*)it->second.get())->Destroy(object);
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			factory->Destroy(object);
+	}
+
+	template <typename T>
+	void cContext::Destroy(cPool<T>* pool, const cHandle& handle)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			factory->Destroy(pool, handle);
+		else
+			pool->Destroy(handle);
+	}
+
+	template <typename T>
+	void cContext::Adopt(T* object)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+			factory->Adopt(object);
+	}
+
+	template <typename T>
+	void cContext::DestroyInPlace(T* object)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+		{
+			factory->DestroyInPlace(object);
+		}
+		else
+		{
+			object->~T();
+		}
+	}
+
+	template <typename T>
+	void cContext::Relocate(T* destination, T* source)
+	{
+		cFactory<T>* factory = (cFactory<T>*)_factories[cTypeIndex<T>::value];
+		if (factory != nullptr)
+		{
+			factory->Relocate(destination, source);
+		}
+		else
+		{
+			new (destination) T(std::move(*source));
+			source->~T();
+		}
 	}
 
 	template <typename T>
 	void cContext::RegisterFactory()
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _factories.find(type);
-		if (it == _factories.end())
-			_factories.insert({type, std::make_shared<iObject>(this)});
+		const types::u32 index = cTypeIndex<T>::value;
+		if (index != 0 && _factories[index] == nullptr)
+			_factories[index] = new cFactory<T>(this);
+	}
+
+	template <typename T>
+	void cContext::RegisterSubsystem(T* object)
+	{
+		const types::u32 index = cTypeIndex<T>::value;
+		if (index != 0 && _subsystems[index] == nullptr)
+			_subsystems[index] = object;
 	}
 
 	template <typename T>
 	T* cContext::GetFactory() const
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _factories.find(type);
-		if (it != _factories.end())
-			return (T*)it->second.get();
-		else
-			return nullptr;
+		return (T*)_factories[cTypeIndex<T>::value];
 	}
 
 	template <typename T>
 	T* cContext::GetSubsystem() const
 	{
-		const ClassType type = T::GetTypeStatic();
-		const auto it = _subsystems.find(type);
-		if (it != _subsystems.end())
-			return (T*)it->second.get();
-		else
-			return nullptr;
+		return (T*)_subsystems[cTypeIndex<T>::value];
 	}
 }
\ No newline at end of file
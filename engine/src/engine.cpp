@@ -17,6 +17,7 @@
 #include "render_context.hpp"
 #include "audio.hpp"
 #include "math.hpp"
+#include "memory_pool.hpp"
 
 using namespace types;
 
@@ -27,7 +28,7 @@ namespace triton
 	void cEngine::Initialize()
 	{
 		// Create memory allocator
-		_context->CreateMemoryAllocator();
+		_context->CreateMemoryAllocator(_app->GetCapabilities());
 
 		// Register factories
 		_context->RegisterFactory<cWindow>();
@@ -74,6 +75,7 @@ namespace triton
 		auto camera = _context->GetSubsystem<cCamera>();
 		auto time = _context->GetSubsystem<cTime>();
 		auto physics = _context->GetSubsystem<cPhysics>();
+		cFrameAllocator* frameAllocator = _context->GetFrameAllocator();
 
 		cWindow* window = _app->GetWindow();
 
@@ -81,9 +83,12 @@ namespace triton
 
 		while (window->GetRunState() == K_FALSE)
 		{
+			frameAllocator->BeginFrame();
+			_context->DispatchMemoryBudgetEvents();
 			time->Update();
 			physics->Simulate();
 			camera->Update();
+			gfx->DefragmentGeometryBuffer(_app->GetCapabilities()->geometryDefragmentationByteSize);
 			gfx->CompositeFinal();
 			window->SwapBuffers();
 			window->PollEvents();
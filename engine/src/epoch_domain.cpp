@@ -0,0 +1,110 @@
+// epoch_domain.cpp
+
+#include <string>
+#include "epoch_domain.hpp"
+#include "log.hpp"
+
+using namespace types;
+
+namespace triton
+{
+	static std::atomic<u64> epochThreadMask = { 0 };
+
+	class cEpochThreadOwner
+	{
+	public:
+		explicit cEpochThreadOwner()
+		{
+			u64 mask = epochThreadMask.load(std::memory_order_relaxed);
+			while (mask != 0xFFFFFFFFFFFFFFFFull)
+			{
+				u32 index = 0;
+				while ((mask & ((u64)1 << index)) != 0)
+					index += 1;
+
+				if (epochThreadMask.compare_exchange_weak(mask, mask | ((u64)1 << index), std::memory_order_acq_rel))
+				{
+					_index = index;
+					return;
+				}
+			}
+
+			Print("Error: more than " + std::to_string(cEpochDomain::MAX_THREAD_COUNT) + " reader threads, extra readers block reclamation while they read!");
+		}
+
+		~cEpochThreadOwner()
+		{
+			if (_index != cEpochDomain::K_INVALID_THREAD)
+				epochThreadMask.fetch_and(~((u64)1 << _index), std::memory_order_acq_rel);
+		}
+
+		inline u32 GetIndex() const { return _index; }
+
+	private:
+		u32 _index = cEpochDomain::K_INVALID_THREAD;
+	};
+
+	u32 cEpochDomain::GetThreadIndex()
+	{
+		static thread_local cEpochThreadOwner owner;
+
+		return owner.GetIndex();
+	}
+
+	void cEpochDomain::Enter()
+	{
+		const u32 index = GetThreadIndex();
+		if (index == K_INVALID_THREAD)
+		{
+			_overflowReaderCount.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			return;
+		}
+
+		sEpochSlot& slot = _slots[index];
+		if (slot._depth++ == 0)
+		{
+			// Publish the pin before any shared pointer is loaded, pairs with the fence in GetMinReaderEpoch
+			slot._epoch.store(_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+		}
+	}
+
+	void cEpochDomain::Leave()
+	{
+		const u32 index = GetThreadIndex();
+		if (index == K_INVALID_THREAD)
+		{
+			_overflowReaderCount.fetch_sub(1, std::memory_order_release);
+			return;
+		}
+
+		sEpochSlot& slot = _slots[index];
+		if (--slot._depth == 0)
+			slot._epoch.store(0, std::memory_order_release);
+	}
+
+	u64 cEpochDomain::Retire()
+	{
+		// Memory unlinked before this point can only be reached by readers pinned at the returned epoch or older
+		return _epoch.fetch_add(1, std::memory_order_seq_cst);
+	}
+
+	u64 cEpochDomain::GetMinReaderEpoch() const
+	{
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		if (_overflowReaderCount.load(std::memory_order_acquire) != 0)
+			return 0;
+
+		u64 minEpoch = K_NO_READER_EPOCH;
+		for (usize i = 0; i < MAX_THREAD_COUNT; i++)
+		{
+			const u64 epoch = _slots[i]._epoch.load(std::memory_order_acquire);
+			if (epoch != 0 && epoch < minEpoch)
+				minEpoch = epoch;
+		}
+
+		return minEpoch;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,60 @@
+// epoch_domain.hpp
+
+#pragma once
+
+#include <atomic>
+#include "types.hpp"
+
+namespace triton
+{
+	struct alignas(64) sEpochSlot
+	{
+		std::atomic<types::u64> _epoch = { 0 };
+		types::u32 _depth = 0;
+	};
+
+	// Epoch-based reclamation for structures with lock-free readers. Readers pin the current epoch
+	// while they hold pointers, writers retire memory with the epoch it was unlinked in and free it
+	// once every pinned epoch is newer. Each thread owns one slot, shared by every domain.
+	class cEpochDomain
+	{
+	public:
+		static constexpr types::usize MAX_THREAD_COUNT = 64;
+		static constexpr types::u32 K_INVALID_THREAD = 0xFFFFFFFF;
+		static constexpr types::u64 K_NO_READER_EPOCH = 0xFFFFFFFFFFFFFFFFull;
+
+	public:
+		explicit cEpochDomain() = default;
+		~cEpochDomain() = default;
+
+		cEpochDomain(const cEpochDomain& rhs) = delete;
+		cEpochDomain& operator=(const cEpochDomain& rhs) = delete;
+
+		void Enter();
+		void Leave();
+		types::u64 Retire();
+		types::u64 GetMinReaderEpoch() const;
+
+		inline types::boolean IsReclaimable(types::u64 retireEpoch, types::u64 minReaderEpoch) const { return retireEpoch < minReaderEpoch ? types::K_TRUE : types::K_FALSE; }
+
+		static types::u32 GetThreadIndex();
+
+	private:
+		std::atomic<types::u64> _epoch = { 1 };
+		std::atomic<types::u64> _overflowReaderCount = { 0 };
+		sEpochSlot _slots[MAX_THREAD_COUNT];
+	};
+
+	class cEpochReadScope
+	{
+	public:
+		explicit cEpochReadScope(cEpochDomain* domain) : _domain(domain) { _domain->Enter(); }
+		~cEpochReadScope() { _domain->Leave(); }
+
+		cEpochReadScope(const cEpochReadScope& rhs) = delete;
+		cEpochReadScope& operator=(const cEpochReadScope& rhs) = delete;
+
+	private:
+		cEpochDomain* _domain = nullptr;
+	};
+}
\ No newline at end of file
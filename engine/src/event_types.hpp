@@ -11,6 +11,7 @@ namespace triton
     enum class eEventType
     {
         NONE,
-        KEY_PRESS
+        KEY_PRESS,
+        MEMORY_BUDGET_SOFT_LIMIT
     };
 }
\ No newline at end of file
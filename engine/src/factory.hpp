@@ -7,12 +7,16 @@
 #include "memory_pool.hpp"
 #include "log.hpp"
 #include "object.hpp"
-#include "hash_table.hpp"
+#include "handle.hpp"
 #include "types.hpp"
 
 namespace triton
 {
 	class cContext;
+	template <typename T>
+	class cFactory;
+	template <typename T>
+	class cPool;
 
 	template <typename T>
 	class cFactoryObject : public cObjectPtr
@@ -35,7 +39,15 @@ namespace triton
 		cFactoryObject<T> Create(Args&&... args);
 		template <typename... Args>
 		cFactoryObject<T> Create(types::u8* data, types::u32 index, Args&&... args);
+		template <typename... Args>
+		cHandle Create(cPool<T>* pool, Args&&... args);
+		template <typename... Args>
+		T* CreateBatch(types::u8* data, types::u32 index, types::usize count, const Args&... args);
 		void Destroy(cFactoryObject<T>& object);
+		void Destroy(cPool<T>* pool, const cHandle& handle);
+		void Adopt(T* object);
+		void DestroyInPlace(T* object);
+		void Relocate(T* destination, T* source);
 
 	private:
 		types::boolean AssertCounter();
@@ -44,10 +56,14 @@ namespace triton
 
 	private:
 		types::usize _counter = 0;
+		types::u32 _typeIndex = cMemoryAllocator::K_INVALID_TYPE;
 	};
 
 	template <typename T>
-	cFactory<T>::cFactory(cContext* context) : iObject(context) {}
+	cFactory<T>::cFactory(cContext* context) : iObject(context)
+	{
+		_typeIndex = _context->GetMemoryAllocator()->RegisterType(T::GetTypeNameStatic());
+	}
 
 	template <typename T>
 	template <typename... Args>
@@ -65,29 +81,107 @@ namespace triton
 		return New(ptr, index, std::forward<Args>(args)...);
 	}
 
+	template <typename T>
+	template <typename... Args>
+	cHandle cFactory<T>::Create(cPool<T>* pool, Args&&... args)
+	{
+		AssertCounter();
+
+		const cHandle handle = pool->Create(std::forward<Args>(args)...);
+		T* object = pool->Find(handle);
+		if (object != nullptr)
+		{
+			object->_id = cIdentifier::Generate(T::GetTypeNameStatic());
+			_context->GetMemoryAllocator()->RecordTypeAllocation(_typeIndex, 0, object, object->GetID());
+		}
+
+		return handle;
+	}
+
+	template <typename T>
+	template <typename... Args>
+	T* cFactory<T>::CreateBatch(types::u8* data, types::u32 index, types::usize count, const Args&... args)
+	{
+		AssertCounter();
+
+		// Every object is built from the same arguments, one sequence range covers all identifiers
+		T* objects = &(((T*)data)[index]);
+		const types::u64 sequence = cIdentifier::ReserveSequence(count);
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		for (types::usize i = 0; i < count; i++)
+		{
+			T* object = &objects[i];
+			new (object) T(args...);
+			object->_id = cIdentifier::Generate(T::GetTypeNameStatic(), sequence + i);
+			memoryAllocator->RecordTypeAllocation(_typeIndex, 0, object, object->GetID());
+		}
+
+		return objects;
+	}
+
 	template <typename T>
 	void cFactory<T>::Destroy(cFactoryObject<T>& object)
 	{
-		T* objectPtr = object.object;
+		T* objectPtr = (T*)object.object;
+		const types::boolean allocated = object.allocated;
 
 		if (objectPtr == nullptr)
 			return;
 
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		memoryAllocator->RecordTypeDeallocation(_typeIndex, allocated == types::K_TRUE ? sizeof(T) : 0, objectPtr);
+
 		objectPtr->~T();
 
-		if (objectPtr->allocated == types::K_TRUE)
+		if (allocated == types::K_TRUE)
 		{
-			cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
 			memoryAllocator->Deallocate(objectPtr);
 		}
 	}
 
+	template <typename T>
+	void cFactory<T>::Destroy(cPool<T>* pool, const cHandle& handle)
+	{
+		T* object = pool->Find(handle);
+		if (object == nullptr)
+			return;
+
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		memoryAllocator->RecordTypeDeallocation(_typeIndex, 0, object);
+
+		// The pool moves its last object into the hole
+		T* lastObject = pool->GetElement((types::u32)pool->GetElementCount() - 1);
+		pool->Destroy(handle);
+		memoryAllocator->RecordTypeRelocation(_typeIndex, lastObject, object);
+	}
+
+	template <typename T>
+	void cFactory<T>::Adopt(T* object)
+	{
+		_context->GetMemoryAllocator()->RecordTypeAllocation(_typeIndex, 0, object, object->GetID());
+	}
+
+	template <typename T>
+	void cFactory<T>::DestroyInPlace(T* object)
+	{
+		_context->GetMemoryAllocator()->RecordTypeDeallocation(_typeIndex, 0, object);
+		object->~T();
+	}
+
+	template <typename T>
+	void cFactory<T>::Relocate(T* destination, T* source)
+	{
+		new (destination) T(std::move(*source));
+		source->~T();
+		_context->GetMemoryAllocator()->RecordTypeRelocation(_typeIndex, source, destination);
+	}
+
 	template <typename T>
 	types::boolean cFactory<T>::AssertCounter()
 	{
 		if (_counter >= types::K_USIZE_MAX)
 		{
-			Print("Error: can't create object of type '" + T::GetTypeStatic() + "'!");
+			Print("Error: can't create object of type '" + std::string(T::GetTypeNameStatic()) + "'!");
 
 			return types::K_TRUE;
 		}
@@ -103,7 +197,7 @@ namespace triton
 
 		if (data == nullptr)
 		{
-			const sCapabilities* caps = _context->GetSubsystem<cEngine>()->GetApplication()->GetCapabilities();
+			const sCapabilities* caps = _context->GetCapabilities();
 			cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
 			fo.object = (T*)memoryAllocator->Allocate(sizeof(T), caps->memoryAlignment);
 			fo.allocated = types::K_TRUE;
@@ -116,7 +210,10 @@ namespace triton
 
 		new (fo.object) T(std::forward<Args>(args)...);
 
-		fo.object->_identifier = cIdentifier::Generate(T::GetTypeStatic());
+		fo.object->_id = cIdentifier::Generate(T::GetTypeNameStatic());
+
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		memoryAllocator->RecordTypeAllocation(_typeIndex, fo.allocated == types::K_TRUE ? sizeof(T) : 0, fo.object, fo.object->GetID());
 
 		return fo;
 	}
@@ -38,7 +38,7 @@ namespace triton
         iGraphicsAPI* gfx = _context->GetSubsystem<cGraphics>()->GetAPI();
 
         for (const auto& glyph : _alphabet)
-            memoryAllocator->Deallocate(glyph.second._bitmapData);
+            memoryAllocator->Deallocate(glyph.second._bitmapData, eMemoryBudget::FONT);
         _alphabet.clear();
 
         gfx->DestroyTexture(_atlas);
@@ -74,7 +74,7 @@ namespace triton
                 glyph._top = ftFont->glyph->bitmap_top;
                 glyph._advanceX = ftFont->glyph->advance.x >> 6;
                 glyph._advanceY = ftFont->glyph->advance.y >> 6;
-                glyph._bitmapData = memoryAllocator->Allocate(glyph._width * glyph._height, caps->memoryAlignment);
+                glyph._bitmapData = memoryAllocator->Allocate(glyph._width * glyph._height, caps->memoryAlignment, eMemoryBudget::FONT);
 
                 if (ftFont->glyph->bitmap.buffer)
                     memcpy(glyph._bitmapData, ftFont->glyph->bitmap.buffer, glyph._width * glyph._height);
@@ -110,7 +110,7 @@ namespace triton
 
         usize maxGlyphHeight = 0;
 
-        void* atlasPixels = memoryAllocator->Allocate(atlasWidth * atlasHeight, caps->memoryAlignment);
+        void* atlasPixels = memoryAllocator->Allocate(atlasWidth * atlasHeight, caps->memoryAlignment, eMemoryBudget::FONT);
         memset(atlasPixels, 0, atlasWidth * atlasHeight);
 
         usize xOffset = 0;
@@ -156,7 +156,7 @@ namespace triton
             atlasPixels
         );
 
-        memoryAllocator->Deallocate(atlasPixels);
+        memoryAllocator->Deallocate(atlasPixels, eMemoryBudget::FONT);
     }
 
     cText::cText(cContext* context) : iObject(context) {}
@@ -5,6 +5,8 @@
 #include "render_manager.hpp"
 #include "physics_manager.hpp"
 #include "memory_pool.hpp"
+#include "context.hpp"
+#include "engine.hpp"
 
 using namespace types;
 
@@ -12,7 +14,9 @@ namespace triton
 {
     cGameObject::cGameObject(cContext* context) : iObject(context)
     {
-        sTransform* pTransform = (sTransform*)(memoryPool->Allocate(sizeof(sTransform)));
+        const sCapabilities* caps = _context->GetSubsystem<cEngine>()->GetApplication()->GetCapabilities();
+        cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+        sTransform* pTransform = (sTransform*)memoryAllocator->Allocate(sizeof(sTransform), caps->memoryAlignment, eMemoryBudget::GAME_OBJECT);
         _transform = new (pTransform) sTransform();
     }
 
@@ -28,6 +28,18 @@ using namespace types;
 
 namespace triton
 {
+    static usize GetVertexFormatByteSize(eCategory format)
+    {
+        switch (format)
+        {
+        case eCategory::VERTEX_BUFFER_FORMAT_POS_TEX_NRM_VEC3_VEC2_VEC3:
+            return 32;
+
+        default:
+            return 0;
+        }
+    }
+
     sRenderInstance::sRenderInstance(s32 materialIndex, const cTransform& transform)
     {
         _use2D = transform._use2D;
@@ -131,27 +143,27 @@ namespace triton
         _opaqueTextureAtlasTexturesBuffer = gfx->CreateBuffer(_maxTextureAtlasTexturesBufferByteSize, cBuffer::eType::LARGE, 3, nullptr);
         _transparentTextureAtlasTexturesBuffer = gfx->CreateBuffer(_maxTextureAtlasTexturesBufferByteSize, cBuffer::eType::LARGE, 3, nullptr);
 
-        _vertices = memoryAllocator->Allocate(caps->vertexBufferSize, caps->memoryAlignment);
-        _verticesByteSize = 0;
-        _indices = memoryAllocator->Allocate(caps->indexBufferSize, caps->memoryAlignment);
-        _indicesByteSize = 0;
-        _opaqueInstances = memoryAllocator->Allocate(_maxOpaqueInstanceBufferByteSize, caps->memoryAlignment);
+        _vertices = memoryAllocator->Allocate(caps->vertexBufferSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
+        _vertexRanges = new cRangeAllocator(caps->vertexBufferSize, GetVertexFormatByteSize(eCategory::VERTEX_BUFFER_FORMAT_POS_TEX_NRM_VEC3_VEC2_VEC3));
+        _indices = memoryAllocator->Allocate(caps->indexBufferSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
+        _indexRanges = new cRangeAllocator(caps->indexBufferSize, sizeof(index));
+        _opaqueInstances = memoryAllocator->Allocate(_maxOpaqueInstanceBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _opaqueInstancesByteSize = 0;
-        _transparentInstances = memoryAllocator->Allocate(_maxTransparentInstanceBufferByteSize, caps->memoryAlignment);
+        _transparentInstances = memoryAllocator->Allocate(_maxTransparentInstanceBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _transparentInstancesByteSize = 0;
-        _textInstances = memoryAllocator->Allocate(_maxTextInstanceBufferByteSize, caps->memoryAlignment);
+        _textInstances = memoryAllocator->Allocate(_maxTextInstanceBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _textInstancesByteSize = 0;
-        _opaqueMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment);
+        _opaqueMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _opaqueMaterialsByteSize = 0;
-        _transparentMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment);
+        _transparentMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _transparentMaterialsByteSize = 0;
-        _textMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment);
+        _textMaterials = memoryAllocator->Allocate(_maxMaterialBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _textMaterialsByteSize = 0;
-        _lights = memoryAllocator->Allocate(_maxLightBufferByteSize, caps->memoryAlignment);
+        _lights = memoryAllocator->Allocate(_maxLightBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _lightsByteSize = 0;
-        _opaqueTextureAtlasTextures = memoryAllocator->Allocate(_maxTextureAtlasTexturesBufferByteSize, caps->memoryAlignment);
+        _opaqueTextureAtlasTextures = memoryAllocator->Allocate(_maxTextureAtlasTexturesBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _opaqueTextureAtlasTexturesByteSize = 0;
-        _transparentTextureAtlasTextures = memoryAllocator->Allocate(_maxTextureAtlasTexturesBufferByteSize, caps->memoryAlignment);
+        _transparentTextureAtlasTextures = memoryAllocator->Allocate(_maxTextureAtlasTexturesBufferByteSize, caps->memoryAlignment, eMemoryBudget::RENDER_STAGING);
         _transparentTextureAtlasTexturesByteSize = 0;
         _materialsMap = _context->Create<std::unordered_map<cMaterial*, s32>>();
 
@@ -280,17 +292,19 @@ namespace triton
 
         _context->Destroy<std::unordered_map<cMaterial*, s32>>(_materialsMap);
 
-        memoryAllocator->Deallocate(_transparentTextureAtlasTextures);
-        memoryAllocator->Deallocate(_opaqueTextureAtlasTextures);
-        memoryAllocator->Deallocate(_lights);
-        memoryAllocator->Deallocate(_textMaterials);
-        memoryAllocator->Deallocate(_transparentMaterials);
-        memoryAllocator->Deallocate(_opaqueMaterials);
-        memoryAllocator->Deallocate(_textInstances);
-        memoryAllocator->Deallocate(_transparentInstances);
-        memoryAllocator->Deallocate(_opaqueInstances);
-        memoryAllocator->Deallocate(_indices);
-        memoryAllocator->Deallocate(_vertices);
+        memoryAllocator->Deallocate(_transparentTextureAtlasTextures, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_opaqueTextureAtlasTextures, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_lights, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_textMaterials, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_transparentMaterials, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_opaqueMaterials, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_textInstances, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_transparentInstances, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_opaqueInstances, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_indices, eMemoryBudget::RENDER_STAGING);
+        memoryAllocator->Deallocate(_vertices, eMemoryBudget::RENDER_STAGING);
+        delete _indexRanges;
+        delete _vertexRanges;
 
         gfx->DestroyBuffer(_transparentTextureAtlasTexturesBuffer);
         gfx->DestroyBuffer(_opaqueTextureAtlasTexturesBuffer);
@@ -341,39 +355,48 @@ namespace triton
 
     sVertexBufferGeometry* cGraphics::CreateGeometry(eCategory format, usize verticesByteSize, const void* vertices, usize indicesByteSize, const void* indices)
     {
-        sVertexBufferGeometry* geometry = _context->Create<sVertexBufferGeometry>();
-
-        memcpy((void*)((usize)_vertices + _verticesByteSize), vertices, verticesByteSize);
-        memcpy((void*)((usize)_indices + _indicesByteSize), indices, indicesByteSize);
+        const usize vertexByteSize = GetVertexFormatByteSize(format);
+        if (vertexByteSize == 0)
+        {
+            Print("Error: unsupported vertex buffer format!");
+            return nullptr;
+        }
 
-        _gfx->WriteBuffer(_vertexBuffer, _verticesByteSize, verticesByteSize, vertices);
-        _gfx->WriteBuffer(_indexBuffer, _indicesByteSize, indicesByteSize, indices);
+        sVertexBufferGeometry* geometry = _context->Create<sVertexBufferGeometry>();
 
-        usize vertexCount = verticesByteSize;
-        usize vertexOffset = _verticesByteSize;
-        switch (format)
+        const u32 vertexRange = _vertexRanges->Allocate(verticesByteSize, geometry);
+        const u32 indexRange = _indexRanges->Allocate(indicesByteSize, geometry);
+        if (vertexRange == cRangeAllocator::K_INVALID_RANGE || indexRange == cRangeAllocator::K_INVALID_RANGE)
         {
-        case eCategory::VERTEX_BUFFER_FORMAT_POS_TEX_NRM_VEC3_VEC2_VEC3:
-            vertexCount /= 32;
-            vertexOffset /= 32;
-            break;
+            Print("Error: geometry buffer is out of memory!");
+            if (vertexRange != cRangeAllocator::K_INVALID_RANGE)
+                _vertexRanges->Deallocate(vertexRange);
+            if (indexRange != cRangeAllocator::K_INVALID_RANGE)
+                _indexRanges->Deallocate(indexRange);
+            _context->Destroy<sVertexBufferGeometry>(geometry);
 
-        default:
-            Print("Error: unsupported vertex buffer format!");
             return nullptr;
         }
 
-        geometry->_vertexCount = vertexCount;
+        const usize verticesOffset = _vertexRanges->GetOffset(vertexRange);
+        const usize indicesOffset = _indexRanges->GetOffset(indexRange);
+
+        memcpy((void*)((usize)_vertices + verticesOffset), vertices, verticesByteSize);
+        memcpy((void*)((usize)_indices + indicesOffset), indices, indicesByteSize);
+
+        _gfx->WriteBuffer(_vertexBuffer, verticesOffset, verticesByteSize, vertices);
+        _gfx->WriteBuffer(_indexBuffer, indicesOffset, indicesByteSize, indices);
+
+        geometry->_vertexCount = verticesByteSize / vertexByteSize;
         geometry->_indexCount = indicesByteSize / sizeof(u32);
         geometry->_vertexPtr = _vertices;
         geometry->_indexPtr = _indices;
-        geometry->_offsetVertex = vertexOffset;
-        geometry->_offsetIndex = _indicesByteSize;
+        geometry->_offsetVertex = verticesOffset / vertexByteSize;
+        geometry->_offsetIndex = indicesOffset;
+        geometry->_vertexRange = vertexRange;
+        geometry->_indexRange = indexRange;
         geometry->_format = format;
 
-        _verticesByteSize += verticesByteSize;
-        _indicesByteSize += indicesByteSize;
-
         return geometry;
     }
 
@@ -526,6 +549,11 @@ namespace triton
 
     void cGraphics::DestroyGeometry(sVertexBufferGeometry* geometry)
     {
+        if (geometry->_vertexRange != cRangeAllocator::K_INVALID_RANGE)
+            _vertexRanges->Deallocate(geometry->_vertexRange);
+        if (geometry->_indexRange != cRangeAllocator::K_INVALID_RANGE)
+            _indexRanges->Deallocate(geometry->_indexRange);
+
         _context->Destroy<sVertexBufferGeometry>(geometry);
     }
 
@@ -548,8 +576,47 @@ namespace triton
 
     void cGraphics::ClearGeometryBuffer()
     {
-        _verticesByteSize = 0;
-        _indicesByteSize = 0;
+        // Live geometries lose their ranges, DestroyGeometry must not hand them back to the reset allocators
+        std::vector<void*> geometries;
+
+        _vertexRanges->Reset(geometries);
+        for (void* geometry : geometries)
+            ((sVertexBufferGeometry*)geometry)->_vertexRange = cRangeAllocator::K_INVALID_RANGE;
+
+        geometries.clear();
+        _indexRanges->Reset(geometries);
+        for (void* geometry : geometries)
+            ((sVertexBufferGeometry*)geometry)->_indexRange = cRangeAllocator::K_INVALID_RANGE;
+    }
+
+    void cGraphics::DefragmentGeometryBuffer(usize maxMoveByteSize)
+    {
+        if (maxMoveByteSize == 0)
+            return;
+
+        // Live geometry slides towards the start of the buffers, the CPU copies are the source for re-uploading moved ranges
+        std::vector<sRangeMove> moves;
+
+        _vertexRanges->Compact(maxMoveByteSize, moves);
+        for (const auto& move : moves)
+        {
+            sVertexBufferGeometry* geometry = (sVertexBufferGeometry*)move.userData;
+            void* dst = (void*)((usize)_vertices + move.dstOffset);
+            memmove(dst, (const void*)((usize)_vertices + move.srcOffset), move.byteSize);
+            _gfx->WriteBuffer(_vertexBuffer, move.dstOffset, move.byteSize, dst);
+            geometry->_offsetVertex = move.dstOffset / GetVertexFormatByteSize(geometry->_format);
+        }
+
+        moves.clear();
+        _indexRanges->Compact(maxMoveByteSize, moves);
+        for (const auto& move : moves)
+        {
+            sVertexBufferGeometry* geometry = (sVertexBufferGeometry*)move.userData;
+            void* dst = (void*)((usize)_indices + move.dstOffset);
+            memmove(dst, (const void*)((usize)_indices + move.srcOffset), move.byteSize);
+            _gfx->WriteBuffer(_indexBuffer, move.dstOffset, move.byteSize, dst);
+            geometry->_offsetIndex = move.dstOffset;
+        }
     }
 
     void cGraphics::ClearRenderPass(const cRenderPass* renderPass, types::boolean clearColor, usize bufferIndex, const glm::vec4& color, types::boolean clearDepth, f32 depth)
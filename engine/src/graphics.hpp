@@ -7,6 +7,7 @@
 #include "render_context.hpp"
 #include "category.hpp"
 #include "cache.hpp"
+#include "range_allocator.hpp"
 #include "types.hpp"
 
 namespace triton
@@ -40,6 +41,8 @@ namespace triton
         void* _indexPtr = nullptr;
         types::usize _offsetVertex = 0;
         types::usize _offsetIndex = 0;
+        types::u32 _vertexRange = cRangeAllocator::K_INVALID_RANGE;
+        types::u32 _indexRange = cRangeAllocator::K_INVALID_RANGE;
         eCategory _format = eCategory::VERTEX_BUFFER_FORMAT_NONE;
     };
 
@@ -195,6 +198,7 @@ namespace triton
         void DestroyModel(sModel* model);
         
         void ClearGeometryBuffer();
+        void DefragmentGeometryBuffer(types::usize maxMoveByteSize);
         void ClearRenderPass(const cRenderPass* renderPass, types::boolean clearColor, types::usize bufferIndex, const glm::vec4& color, types::boolean clearDepth, types::f32 depth);
         void ClearRenderPasses(const glm::vec4& clearColor, types::f32 clearDepth);
         void ResizeRenderTargets(const glm::vec2& size);
@@ -256,9 +260,9 @@ namespace triton
         types::usize _opaqueInstanceCount = 0;
         types::usize _transparentInstanceCount = 0;
         void* _vertices = nullptr;
-        types::usize _verticesByteSize = 0;
+        cRangeAllocator* _vertexRanges = nullptr;
         void* _indices = nullptr;
-        types::usize _indicesByteSize = 0;
+        cRangeAllocator* _indexRanges = nullptr;
         void* _opaqueInstances = nullptr;
         types::usize _opaqueInstancesByteSize = 0;
         void* _transparentInstances = nullptr;
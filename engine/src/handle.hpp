@@ -6,11 +6,26 @@ namespace triton
 {
 	class cHandle
 	{
+		template <typename T>
+		friend class cPool;
+
 	public:
 		using index = types::u32;
 
+	public:
+		explicit cHandle() = default;
+		explicit cHandle(index idx_, types::u32 generation_) : idx(idx_), generation(generation_) {}
+
+		inline types::boolean operator==(const cHandle& rhs) const { return idx == rhs.idx && generation == rhs.generation; }
+		inline types::boolean operator!=(const cHandle& rhs) const { return !(*this == rhs); }
+
+		inline index GetIndex() const { return idx; }
+		inline types::u32 GetGeneration() const { return generation; }
+		inline types::u64 GetValue() const { return ((types::u64)generation << 32) | (types::u64)idx; }
+		inline types::boolean IsNull() const { return generation == 0; }
+
 	protected:
 		index idx = 0;
-		types::usize generation = 0;
+		types::u32 generation = 0;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,215 @@
+// hash.hpp
+
+#pragma once
+
+#include <cstring>
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+#include "types.hpp"
+
+namespace triton
+{
+	// 64-bit wyhash-style hash. Compute is usable in constant expressions and reads bytes one by one,
+	// ComputeRuntime gives the same result with unaligned word loads and a native 128-bit multiply.
+	// Keys of 32 bytes or less (every cTag) take a branch-light path without the block loop.
+	class cHash
+	{
+	public:
+		static constexpr types::u64 K_DEFAULT_SEED = 0xa0761d6478bd642full;
+
+	public:
+		static constexpr types::u64 Compute(const types::u8* data, types::usize byteSize, types::u64 seed = K_DEFAULT_SEED) { return Hash<types::u8, types::K_FALSE>(data, byteSize, MixSeed<types::K_FALSE>(seed)); }
+		static constexpr types::u64 Compute(const char* data, types::usize byteSize, types::u64 seed = K_DEFAULT_SEED) { return Hash<char, types::K_FALSE>(data, byteSize, MixSeed<types::K_FALSE>(seed)); }
+		static inline types::u64 ComputeRuntime(const void* data, types::usize byteSize, types::u64 seed = K_DEFAULT_SEED) { return Hash<types::u8, types::K_TRUE>((const types::u8*)data, byteSize, MixSeed<types::K_TRUE>(seed)); }
+
+	private:
+		static constexpr types::u64 K_SECRET0 = 0x2d358dccaa6c78a5ull;
+		static constexpr types::u64 K_SECRET1 = 0x8bb84b93962eacc9ull;
+		static constexpr types::u64 K_SECRET2 = 0x4b33a62ed433d4a3ull;
+		static constexpr types::u64 K_SECRET3 = 0x4d5a2da51de1aa47ull;
+		// MixSeed(K_DEFAULT_SEED) precomputed so the default seed costs no multiply per call, checked in Hash
+		static constexpr types::u64 K_DEFAULT_SEED_MIXED = 0x16d54717a54eabcbull;
+
+		template <typename TByte, types::boolean TRuntime>
+		static constexpr types::u64 Read64(const TByte* data);
+		template <typename TByte, types::boolean TRuntime>
+		static constexpr types::u64 Read32(const TByte* data);
+		template <typename TByte>
+		static constexpr types::u64 Read3(const TByte* data, types::usize byteSize);
+		template <types::boolean TRuntime>
+		static constexpr void Multiply(types::u64& lhs, types::u64& rhs);
+		template <types::boolean TRuntime>
+		static constexpr types::u64 Mix(types::u64 lhs, types::u64 rhs);
+		template <types::boolean TRuntime>
+		static constexpr types::u64 MixSeed(types::u64 seed);
+		template <typename TByte, types::boolean TRuntime>
+		static constexpr types::u64 Hash(const TByte* data, types::usize byteSize, types::u64 seed);
+	};
+
+	template <typename TByte, types::boolean TRuntime>
+	constexpr types::u64 cHash::Read64(const TByte* data)
+	{
+		if constexpr (TRuntime == types::K_TRUE)
+		{
+			types::u64 value = 0;
+			std::memcpy(&value, data, sizeof(value));
+
+			return value;
+		}
+		else
+		{
+			types::u64 value = 0;
+			for (types::usize i = 0; i < 8; i++)
+				value |= (types::u64)(types::u8)data[i] << (i * 8);
+
+			return value;
+		}
+	}
+
+	template <typename TByte, types::boolean TRuntime>
+	constexpr types::u64 cHash::Read32(const TByte* data)
+	{
+		if constexpr (TRuntime == types::K_TRUE)
+		{
+			types::u32 value = 0;
+			std::memcpy(&value, data, sizeof(value));
+
+			return value;
+		}
+		else
+		{
+			types::u64 value = 0;
+			for (types::usize i = 0; i < 4; i++)
+				value |= (types::u64)(types::u8)data[i] << (i * 8);
+
+			return value;
+		}
+	}
+
+	template <typename TByte>
+	constexpr types::u64 cHash::Read3(const TByte* data, types::usize byteSize)
+	{
+		return ((types::u64)(types::u8)data[0] << 16) | ((types::u64)(types::u8)data[byteSize >> 1] << 8) | (types::u64)(types::u8)data[byteSize - 1];
+	}
+
+	template <types::boolean TRuntime>
+	constexpr void cHash::Multiply(types::u64& lhs, types::u64& rhs)
+	{
+		if constexpr (TRuntime == types::K_TRUE)
+		{
+#if defined(__SIZEOF_INT128__)
+			const unsigned __int128 product = (unsigned __int128)lhs * rhs;
+			lhs = (types::u64)product;
+			rhs = (types::u64)(product >> 64);
+
+			return;
+#elif defined(_MSC_VER) && defined(_M_X64)
+			lhs = _umul128(lhs, rhs, &rhs);
+
+			return;
+#endif
+		}
+
+		// Portable 64x64 -> 128 multiply from 32-bit halves, also the constexpr path
+		const types::u64 lhsHigh = lhs >> 32;
+		const types::u64 lhsLow = (types::u32)lhs;
+		const types::u64 rhsHigh = rhs >> 32;
+		const types::u64 rhsLow = (types::u32)rhs;
+		const types::u64 high = lhsHigh * rhsHigh;
+		const types::u64 middle0 = lhsHigh * rhsLow;
+		const types::u64 middle1 = rhsHigh * lhsLow;
+		const types::u64 low = lhsLow * rhsLow;
+		const types::u64 middle = (low >> 32) + (types::u32)middle0 + (types::u32)middle1;
+
+		lhs = (middle << 32) | (types::u32)low;
+		rhs = high + (middle0 >> 32) + (middle1 >> 32) + (middle >> 32);
+	}
+
+	template <types::boolean TRuntime>
+	constexpr types::u64 cHash::Mix(types::u64 lhs, types::u64 rhs)
+	{
+		Multiply<TRuntime>(lhs, rhs);
+
+		return lhs ^ rhs;
+	}
+
+	template <types::boolean TRuntime>
+	constexpr types::u64 cHash::MixSeed(types::u64 seed)
+	{
+		if (seed == K_DEFAULT_SEED)
+			return K_DEFAULT_SEED_MIXED;
+
+		return seed ^ Mix<TRuntime>(seed ^ K_SECRET0, K_SECRET1);
+	}
+
+	template <typename TByte, types::boolean TRuntime>
+	constexpr types::u64 cHash::Hash(const TByte* data, types::usize byteSize, types::u64 seed)
+	{
+		static_assert(K_DEFAULT_SEED_MIXED == (K_DEFAULT_SEED ^ Mix<types::K_FALSE>(K_DEFAULT_SEED ^ K_SECRET0, K_SECRET1)), "K_DEFAULT_SEED_MIXED is out of date");
+
+		types::u64 lhs = 0;
+		types::u64 rhs = 0;
+		if (byteSize <= 16)
+		{
+			// Two overlapping reads cover the key and a single multiply folds them, most tags end here
+			if (byteSize >= 8)
+			{
+				lhs = Read64<TByte, TRuntime>(data);
+				rhs = Read64<TByte, TRuntime>(data + byteSize - 8);
+			}
+			else if (byteSize >= 4)
+			{
+				lhs = Read32<TByte, TRuntime>(data);
+				rhs = Read32<TByte, TRuntime>(data + byteSize - 4);
+			}
+			else if (byteSize > 0)
+			{
+				lhs = Read3(data, byteSize);
+			}
+
+			return Mix<TRuntime>(lhs ^ K_SECRET1 ^ (types::u64)byteSize, rhs ^ seed);
+		}
+		else if (byteSize <= 32)
+		{
+			seed = Mix<TRuntime>(Read64<TByte, TRuntime>(data) ^ K_SECRET1, Read64<TByte, TRuntime>(data + 8) ^ seed);
+			lhs = Read64<TByte, TRuntime>(data + byteSize - 16);
+			rhs = Read64<TByte, TRuntime>(data + byteSize - 8);
+		}
+		else
+		{
+			const TByte* block = data;
+			types::usize remainingByteSize = byteSize;
+			if (remainingByteSize > 48)
+			{
+				types::u64 seed1 = seed;
+				types::u64 seed2 = seed;
+				do
+				{
+					seed = Mix<TRuntime>(Read64<TByte, TRuntime>(block) ^ K_SECRET1, Read64<TByte, TRuntime>(block + 8) ^ seed);
+					seed1 = Mix<TRuntime>(Read64<TByte, TRuntime>(block + 16) ^ K_SECRET2, Read64<TByte, TRuntime>(block + 24) ^ seed1);
+					seed2 = Mix<TRuntime>(Read64<TByte, TRuntime>(block + 32) ^ K_SECRET3, Read64<TByte, TRuntime>(block + 40) ^ seed2);
+					block += 48;
+					remainingByteSize -= 48;
+				} while (remainingByteSize > 48);
+				seed ^= seed1 ^ seed2;
+			}
+
+			while (remainingByteSize > 16)
+			{
+				seed = Mix<TRuntime>(Read64<TByte, TRuntime>(block) ^ K_SECRET1, Read64<TByte, TRuntime>(block + 8) ^ seed);
+				block += 16;
+				remainingByteSize -= 16;
+			}
+
+			lhs = Read64<TByte, TRuntime>(block + remainingByteSize - 16);
+			rhs = Read64<TByte, TRuntime>(block + remainingByteSize - 8);
+		}
+
+		lhs ^= K_SECRET1;
+		rhs ^= seed;
+		Multiply<TRuntime>(lhs, rhs);
+
+		return Mix<TRuntime>(lhs ^ K_SECRET0 ^ (types::u64)byteSize, rhs ^ K_SECRET1);
+	}
+}
\ No newline at end of file
@@ -2,17 +2,22 @@
 
 #pragma once
 
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include "object.hpp"
 #include "context.hpp"
 #include "memory_pool.hpp"
+#include "snapshot.hpp"
 #include "types.hpp"
 
 namespace triton
 {
-	struct sChunkElement
+	struct sHashTableSlot
 	{
-		types::u32 chunk = 0;
-		types::u32 position = 0;
+		types::u32 hash = 0;
+		types::u32 element = 0;
 	};
 
 	struct sChunkAllocatorDescriptor
@@ -22,27 +27,84 @@ namespace triton
 		types::usize hashTableByteSize = 4096;
 	};
 
+	// One member mirrored out of every element, stored per chunk at offset * objectCountPerChunk in the chunk's column block
+	struct sHashTableColumn
+	{
+		using ReadFunction = void (*)();
+		using WriteFunction = void (*)(ReadFunction read, const void* object, types::u8* value);
+
+		types::usize byteSize = 0;
+		types::usize offset = 0;
+		ReadFunction read = nullptr;
+		WriteFunction write = nullptr;
+	};
+
+	template <typename C>
+	struct sHashTableColumnSpan
+	{
+		const C* data = nullptr;
+		types::usize count = 0;
+	};
+
+	// Elements live in fixed-size chunks, lookups go through a Robin Hood index of (hash, element position) slots.
+	// Hash 0 marks an empty slot, deletion shifts the following cluster back so no tombstones are left.
+	// Columns optionally mirror selected members into parallel per-chunk arrays, so hot loops can stream
+	// one field with GetColumn instead of pulling whole elements. They are read from the element on insert and
+	// when erase moves it, and again through RefreshColumns when the owner changes a mirrored member.
+	// Save writes the used chunks and the index of a relocatable type to a snapshot file, Restore maps such a file
+	// copy-on-write and uses it in place: only chunk pointers and each element's iObject header are fixed up.
 	template <typename T>
 	class cHashTable : public iObject
 	{
+		TRITON_OBJECT(cHashTable)
+
+	public:
+		static constexpr types::u32 K_INVALID_SLOT = 0xFFFFFFFF;
+		static constexpr types::u32 K_INVALID_COLUMN = 0xFFFFFFFF;
+		static constexpr types::u32 K_MAX_COLUMN_COUNT = 8;
+
 	public:
 		explicit cHashTable(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc);
 		virtual ~cHashTable() override final;
 
 		template<typename... Args>
 		T* Insert(Args&&... args);
+		template<typename... Args>
+		types::usize InsertBatch(types::usize count, T** objects, const Args&... args);
 		T* Find(const cTag& key);
 		void Erase(const cTag& key);
+		void EraseBatch(const cTag* keys, types::usize count);
+
+		template <typename C>
+		types::u32 AddColumn(C (*read)(const T& object));
+		void RefreshColumns(const cTag& key);
+		template <typename C>
+		sHashTableColumnSpan<C> GetColumn(types::u32 column, types::u32 chunkIndex) const;
+		types::boolean Save(const std::string& path) const;
+		types::boolean Restore(const std::string& path, const T& prototype);
 
 		inline const T* GetElement(types::u32 index) const;
 		inline types::usize GetElementCount() const { return _elementCount; }
+		inline types::usize GetChunkCount() const { return _chunkCount; }
 
 	private:
 		types::u32 AllocateChunk();
 		void DeallocateChunk(types::u32 chunkIndex);
 		types::u32 GetChunkIndex(types::u32 globalPosition);
 		types::u32 GetChunkLocalPosition(types::u32 chunkIndex, types::u32 globalPosition);
-		types::cpuword MakeHashMask(types::usize size);
+		inline T* GetElementPtr(types::u32 globalPosition) const { return &_chunks[globalPosition / _objectCountPerChunk][globalPosition % _objectCountPerChunk]; }
+		static types::u32 MakeHash(const cTag& key);
+		types::u32 FindSlot(const cTag& key, types::u32 hash) const;
+		void InsertSlot(types::u32 hash, types::u32 element);
+		void PlaceSlot(sHashTableSlot entry);
+		void EraseSlot(types::u32 slot);
+		void EraseElement(types::u32 slot);
+		void ReleaseChunks();
+		void GrowSlots(types::usize slotCount);
+		void WriteColumns(types::u32 element);
+		inline types::u8* GetColumnPtr(const sHashTableColumn& column, types::u32 element) const { return _columnChunks[element / _objectCountPerChunk] + column.offset * _objectCountPerChunk + (element % _objectCountPerChunk) * column.byteSize; }
+		template <typename C>
+		static void WriteColumn(sHashTableColumn::ReadFunction read, const void* object, types::u8* value);
 
 	private:
 		sChunkAllocatorDescriptor _allocatorDesc = {};
@@ -51,43 +113,69 @@ namespace triton
 		types::usize _objectCountPerChunk = 0;
 		types::usize _elementCount = 0;
 		T** _chunks = nullptr;
-		types::usize _hashTableSize = 0;
-		types::cpuword _hashMask = 0;
-		sChunkElement* _hashTable = nullptr;
+		types::usize _slotCount = 0;
+		types::u32 _slotMask = 0;
+		sHashTableSlot* _slots = nullptr;
+		types::u32 _columnCount = 0;
+		types::usize _columnByteSize = 0;
+		sHashTableColumn _columns[K_MAX_COLUMN_COUNT] = {};
+		types::u8** _columnChunks = nullptr;
+		cMappedFile* _snapshot = nullptr;
+		types::usize _mappedChunkCount = 0;
+		types::boolean _mappedSlots = types::K_FALSE;
 	};
 
 	template <typename T>
 	cHashTable<T>::cHashTable(cContext* context, const sChunkAllocatorDescriptor& allocatorDesc) : iObject(context)
 	{
-		const sCapabilities* caps = _context->GetSubsystem<cEngine>()->GetApplication()->GetCapabilities();
+		const sCapabilities* caps = _context->GetCapabilities();
 		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
 
 		_allocatorDesc = allocatorDesc;
 		_objectByteSize = sizeof(T);
-		_objectCountPerChunk = chunkByteSize / _objectByteSize;
-		_chunks = (T**)memoryAllocator->Allocate(_maxChunkCount * sizeof(T*), caps->memoryAlignment);
-		_hashTableSize = hashTableSize;
-		_hashMask = MakeHashMask(hashTableSize);
-		_hashTable = (sChunkElement*)memoryAllocator->Allocate(_hashTableSize * sizeof(sChunkElement), caps->memoryAlignment);
-
-		AllocateNewChunk();
+		_objectCountPerChunk = _allocatorDesc.chunkByteSize / _objectByteSize;
+		_chunks = (T**)memoryAllocator->Allocate(_allocatorDesc.maxChunkCount * sizeof(T*), caps->memoryAlignment);
+
+		_slotCount = 16;
+		while (_slotCount * sizeof(sHashTableSlot) < _allocatorDesc.hashTableByteSize)
+			_slotCount *= 2;
+		_slotMask = (types::u32)(_slotCount - 1);
+		_slots = (sHashTableSlot*)memoryAllocator->Allocate(_slotCount * sizeof(sHashTableSlot), caps->memoryAlignment);
+		for (types::usize i = 0; i < _slotCount; i++)
+			_slots[i] = {};
+
+		AllocateChunk();
 	}
 
 	template <typename T>
 	cHashTable<T>::~cHashTable()
 	{
-		for (types::usize i = 0; i < _chunkCount; i++)
-			DeallocateChunk(i);
+		for (types::usize i = 0; i < _elementCount; i++)
+			_context->DestroyInPlace(GetElementPtr((types::u32)i));
+
+		while (_chunkCount > 0)
+			DeallocateChunk((types::u32)_chunkCount - 1);
 
 		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
-		memoryAllocator->Deallocate(_hashTable);
+		if (_mappedSlots == types::K_FALSE)
+			memoryAllocator->Deallocate(_slots);
 		memoryAllocator->Deallocate(_chunks);
+		if (_columnChunks != nullptr)
+			memoryAllocator->Deallocate(_columnChunks);
+		delete _snapshot;
 	}
 
 	template <typename T>
 	template <typename... Args>
 	T* cHashTable<T>::Insert(Args&&... args)
 	{
+		if (_elementCount >= _allocatorDesc.maxChunkCount * _objectCountPerChunk)
+		{
+			Print("Error: hash table of type '" + std::string(T::GetTypeNameStatic()) + "' is full!");
+
+			return nullptr;
+		}
+
 		types::u32 elementChunkIndex = GetChunkIndex(_elementCount);
 		types::u32 elementLocalPosition = GetChunkLocalPosition(elementChunkIndex, _elementCount);
 
@@ -98,97 +186,334 @@ namespace triton
 			elementLocalPosition = 0;
 		}
 
+		const types::u32 element = (types::u32)_elementCount;
 		_elementCount += 1;
 
 		cHandle::index idx = (cHandle::index)elementLocalPosition;
-		T* object = _context->Create<T>(_chunks[elementChunkIndex], idx, std::forward<Args>(args)...);
+		T* object = _context->Create<T>((types::u8*)_chunks[elementChunkIndex], idx, std::forward<Args>(args)...);
 
-		sChunkElement ce;
-		ce.chunk = elementChunkIndex;
-		ce.position = elementLocalPosition;
-
-		const uint32_t hash = Hash(object->GetID(), _hashMask);
-		_hashTable[hash] = ce;
+		InsertSlot(MakeHash(object->GetID()), element);
+		WriteColumns(element);
 
 		return object;
 	}
 
 	template <typename T>
-	T* cHashTable<T>::Find(const cTag& key)
+	template <typename... Args>
+	types::usize cHashTable<T>::InsertBatch(types::usize count, T** objects, const Args&... args)
 	{
-		const types::cpuword hash = Hash(key.GetData(), key.GetByteSize());
-		const sChunkElement& ce = _hashTable[hash];
-		const types::usize chunkObjectCount = GetChunkLocalPosition(_chunkCount - 1, _elementCount);
-		if (ce.chunk < _chunkCount && ce.position < chunkObjectCount)
+		const types::usize maxElementCount = _allocatorDesc.maxChunkCount * _objectCountPerChunk;
+		if (_elementCount + count > maxElementCount)
 		{
-			const T* object = &_chunks[ce.chunk][ce.position];
-			if (key.Compare(object->GetID()))
-				return (const T*)object;
+			Print("Error: hash table of type '" + std::string(T::GetTypeNameStatic()) + "' can't fit " + std::to_string(count) + " more elements!");
+			count = maxElementCount - _elementCount;
 		}
 
-		for (types::usize i = 0; i < _chunkCount; i++)
+		// Reserve chunks and index room for the whole batch once, so the loop below only constructs and places
+		while (_chunkCount * _objectCountPerChunk < _elementCount + count)
+			AllocateChunk();
+
+		types::usize slotCount = _slotCount;
+		while ((_elementCount + count) * 8 > slotCount * 7)
+			slotCount *= 2;
+		if (slotCount != _slotCount)
+			GrowSlots(slotCount);
+
+		types::usize createdCount = 0;
+		while (createdCount < count)
 		{
-			for (types::usize j = 0; j < _objectCountPerChunk; j++)
+			const types::u32 element = (types::u32)_elementCount;
+			const types::u32 chunkIndex = GetChunkIndex(element);
+			const types::u32 localPosition = GetChunkLocalPosition(chunkIndex, element);
+			types::usize runCount = _objectCountPerChunk - localPosition;
+			if (runCount > count - createdCount)
+				runCount = count - createdCount;
+
+			T* run = _context->CreateBatch<T>((types::u8*)_chunks[chunkIndex], localPosition, runCount, args...);
+			for (types::usize i = 0; i < runCount; i++)
 			{
-				const T* object = &_chunks[i][j];
-				if (key.Compare(object->GetID()))
-					return (const T*)object;
+				sHashTableSlot entry;
+				entry.hash = MakeHash(run[i].GetID());
+				entry.element = element + (types::u32)i;
+				PlaceSlot(entry);
+				WriteColumns(entry.element);
+
+				if (objects != nullptr)
+					objects[createdCount + i] = &run[i];
 			}
+
+			_elementCount += runCount;
+			createdCount += runCount;
 		}
 
-		return nullptr;
+		return createdCount;
+	}
+
+	template <typename T>
+	T* cHashTable<T>::Find(const cTag& key)
+	{
+		const types::u32 slot = FindSlot(key, MakeHash(key));
+		if (slot == K_INVALID_SLOT)
+			return nullptr;
+
+		return GetElementPtr(_slots[slot].element);
 	}
 
 	template <typename T>
 	void cHashTable<T>::Erase(const cTag& key)
 	{
+		const types::u32 slot = FindSlot(key, MakeHash(key));
+		if (slot == K_INVALID_SLOT)
+			return;
+
+		EraseElement(slot);
+		ReleaseChunks();
+	}
+
+	template <typename T>
+	void cHashTable<T>::EraseBatch(const cTag* keys, types::usize count)
+	{
+		for (types::usize i = 0; i < count; i++)
+		{
+			const types::u32 slot = FindSlot(keys[i], MakeHash(keys[i]));
+			if (slot != K_INVALID_SLOT)
+				EraseElement(slot);
+		}
+
+		// Chunks are released once for the whole batch instead of after every element
+		ReleaseChunks();
+	}
+
+	template <typename T>
+	void cHashTable<T>::EraseElement(types::u32 slot)
+	{
+		const types::u32 element = _slots[slot].element;
+		const types::u32 lastElement = (types::u32)_elementCount - 1;
+		EraseSlot(slot);
+
+		// Keep elements contiguous by moving the last one into the hole and patching its slot
+		T* object = GetElementPtr(element);
+		_context->DestroyInPlace(object);
+		if (element != lastElement)
+		{
+			_context->Relocate(object, GetElementPtr(lastElement));
+
+			const cTag& movedKey = object->GetID();
+			_slots[FindSlot(movedKey, MakeHash(movedKey))].element = element;
+			WriteColumns(element);
+		}
+		_elementCount -= 1;
+	}
+
+	template <typename T>
+	void cHashTable<T>::ReleaseChunks()
+	{
+		// The first chunk stays allocated so Insert always has somewhere to place the next element
+		while (_chunkCount > 1 && _elementCount <= (_chunkCount - 1) * _objectCountPerChunk)
+			DeallocateChunk((types::u32)_chunkCount - 1);
+	}
+
+	template <typename T>
+	template <typename C>
+	types::u32 cHashTable<T>::AddColumn(C (*read)(const T& object))
+	{
+		static_assert(std::is_trivially_copyable<C>::value, "Column values are written into raw column memory and must be trivially copyable!");
+
+		// Column blocks share the chunk layout, so the layout is only changed while nothing is stored in it
+		if (_elementCount != 0 || _columnCount >= K_MAX_COLUMN_COUNT)
+		{
+			Print("Error: can't add column to hash table of type '" + std::string(T::GetTypeNameStatic()) + "'!");
+
+			return K_INVALID_COLUMN;
+		}
+
+		const sCapabilities* caps = _context->GetCapabilities();
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		sHashTableColumn& column = _columns[_columnCount];
+		column.byteSize = sizeof(C);
+		column.offset = (_columnByteSize + alignof(C) - 1) & ~(alignof(C) - 1);
+		column.read = (sHashTableColumn::ReadFunction)read;
+		column.write = &WriteColumn<C>;
+		_columnByteSize = column.offset + column.byteSize;
+
+		if (_columnChunks == nullptr)
+		{
+			_columnChunks = (types::u8**)memoryAllocator->Allocate(_allocatorDesc.maxChunkCount * sizeof(types::u8*), caps->memoryAlignment);
+			for (types::usize i = 0; i < _allocatorDesc.maxChunkCount; i++)
+				_columnChunks[i] = nullptr;
+		}
+
 		for (types::usize i = 0; i < _chunkCount; i++)
 		{
-			for (types::usize j = 0; j < _objectCountPerChunk; j++)
-			{
-				if (key.Compare(_chunks[i][j]->GetID()))
-				{
-					const types::u32 lastChunkIndex = GetChunkIndex(_elementCount - 1);
-					const types::usize lastChunkObjectCount = GetChunkLocalPosition(lastChunkIndex, _elementCount);
+			memoryAllocator->Deallocate(_columnChunks[i]);
+			_columnChunks[i] = (types::u8*)memoryAllocator->Allocate(_columnByteSize * _objectCountPerChunk, caps->memoryAlignment);
+		}
 
-					const types::u32 lastIndex = lastChunkObjectCount - 1;
-					_chunks[i][j] = _chunks[lastChunkIndex][lastIndex];
-					_elementCount -= 1;
+		return _columnCount++;
+	}
 
-					if (lastChunkObjectCount == 1)
-						DeallocateChunk(lastChunkIndex);
+	template <typename T>
+	void cHashTable<T>::RefreshColumns(const cTag& key)
+	{
+		const types::u32 slot = FindSlot(key, MakeHash(key));
+		if (slot == K_INVALID_SLOT)
+			return;
 
-					return;
-				}
-			}
+		WriteColumns(_slots[slot].element);
+	}
+
+	template <typename T>
+	template <typename C>
+	sHashTableColumnSpan<C> cHashTable<T>::GetColumn(types::u32 column, types::u32 chunkIndex) const
+	{
+		sHashTableColumnSpan<C> span;
+		if (column >= _columnCount || chunkIndex >= _chunkCount || _columns[column].byteSize != sizeof(C))
+			return span;
+
+		const types::usize chunkBegin = chunkIndex * _objectCountPerChunk;
+		if (chunkBegin >= _elementCount)
+			return span;
+
+		span.data = (const C*)(_columnChunks[chunkIndex] + _columns[column].offset * _objectCountPerChunk);
+		span.count = _elementCount - chunkBegin < _objectCountPerChunk ? _elementCount - chunkBegin : _objectCountPerChunk;
+
+		return span;
+	}
+
+	template <typename T>
+	types::boolean cHashTable<T>::Save(const std::string& path) const
+	{
+		static_assert(sSnapshotRelocatable<T>::value == types::K_TRUE, "Only relocatable types can be saved to a snapshot!");
+
+		if (_allocatorDesc.chunkByteSize % cSnapshot::K_SNAPSHOT_ALIGNMENT != 0)
+		{
+			Print("Error: can't save hash table of type '" + std::string(T::GetTypeNameStatic()) + "', chunk size isn't a multiple of the snapshot alignment!");
+
+			return types::K_FALSE;
 		}
+
+		sSnapshotHeader header;
+		header.type = T::GetTypeStatic();
+		header.objectByteSize = sizeof(T);
+		header.objectCountPerChunk = _objectCountPerChunk;
+		header.chunkByteSize = _allocatorDesc.chunkByteSize;
+		header.chunkCount = (_elementCount + _objectCountPerChunk - 1) / _objectCountPerChunk;
+		header.elementCount = _elementCount;
+		header.slotCount = _slotCount;
+		header.identifierSequence = cIdentifier::GetSequence();
+
+		return cSnapshot::Write(path, header, _slots, _slotCount * sizeof(sHashTableSlot), (const types::u8* const*)_chunks);
 	}
 
 	template <typename T>
-	const T* cHashTable<T>::GetElement(types::u32 index) const
+	types::boolean cHashTable<T>::Restore(const std::string& path, const T& prototype)
 	{
-		const types::u32 chunkIndex = GetChunkIndex(index);
+		static_assert(sSnapshotRelocatable<T>::value == types::K_TRUE, "Only relocatable types can be restored from a snapshot!");
+
+		// Only an empty table adopts mapped storage, columns added before are refilled from the restored elements
+		cMappedFile* snapshot = new cMappedFile();
+		const sSnapshotHeader* header = _elementCount == 0 && snapshot->Open(path) == types::K_TRUE ? cSnapshot::Read(snapshot) : nullptr;
+		if (header == nullptr || header->type != T::GetTypeStatic() || header->objectByteSize != sizeof(T) ||
+			header->objectCountPerChunk != _objectCountPerChunk || header->chunkByteSize != _allocatorDesc.chunkByteSize ||
+			header->chunkCount > _allocatorDesc.maxChunkCount || header->elementCount > header->chunkCount * _objectCountPerChunk ||
+			header->slotCount < 16 || (header->slotCount & (header->slotCount - 1)) != 0 || header->elementCount * 8 > header->slotCount * 7 ||
+			header->slotsOffset + header->slotCount * sizeof(sHashTableSlot) > header->chunksOffset)
+		{
+			Print("Error: can't restore hash table of type '" + std::string(T::GetTypeNameStatic()) + "' from snapshot '" + path + "'!");
+			delete snapshot;
 
-		if (chunkIndex >= _chunkCount)
-			return nullptr;
+			return types::K_FALSE;
+		}
+
+		// Every occupied slot must point at its own restored element, lookups index chunks with it unchecked
+		const sHashTableSlot* slots = (const sHashTableSlot*)(snapshot->GetData() + header->slotsOffset);
+		types::usize occupiedSlotCount = 0;
+		types::boolean corrupt = types::K_FALSE;
+		for (types::usize i = 0; i < header->slotCount && corrupt == types::K_FALSE; i++)
+		{
+			if (slots[i].hash == 0)
+				continue;
+
+			occupiedSlotCount += 1;
+			if (slots[i].element >= header->elementCount)
+				corrupt = types::K_TRUE;
+		}
+		if (corrupt == types::K_TRUE || occupiedSlotCount != header->elementCount)
+		{
+			Print("Error: can't restore hash table of type '" + std::string(T::GetTypeNameStatic()) + "', snapshot '" + path + "' is corrupt!");
+			delete snapshot;
+
+			return types::K_FALSE;
+		}
 
-		const types::usize chunkObjectCount = GetChunkLocalPosition(info.chunk, _elementCount);
-		const types::u32 localPosition = GetChunkLocalPosition(chunkIndex, index);
-		if (localPosition >= chunkObjectCount)
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		while (_chunkCount > 0)
+			DeallocateChunk((types::u32)_chunkCount - 1);
+		if (_mappedSlots == types::K_FALSE)
+			memoryAllocator->Deallocate(_slots);
+		delete _snapshot;
+		_snapshot = snapshot;
+
+		types::u8* data = snapshot->GetData();
+		_slotCount = header->slotCount;
+		_slotMask = (types::u32)(_slotCount - 1);
+		_slots = (sHashTableSlot*)(data + header->slotsOffset);
+		_mappedSlots = types::K_TRUE;
+
+		// Column blocks are never part of a snapshot, they are allocated here and refilled below
+		const sCapabilities* caps = _context->GetCapabilities();
+		for (types::usize i = 0; i < header->chunkCount; i++)
+		{
+			_chunks[i] = (T*)(data + header->chunksOffset + i * header->chunkByteSize);
+			if (_columnCount != 0)
+				_columnChunks[i] = (types::u8*)memoryAllocator->Allocate(_columnByteSize * _objectCountPerChunk, caps->memoryAlignment);
+		}
+		_chunkCount = header->chunkCount;
+		_mappedChunkCount = _chunkCount;
+		_elementCount = header->elementCount;
+		if (_chunkCount == 0)
+			AllocateChunk();
+
+		// Restored ids were generated by the saving process, ids generated from now on must not collide with them
+		cIdentifier::AdvanceSequence(header->identifierSequence);
+
+		// The vtable pointer and context are the only process-local state a relocatable type holds,
+		// both sit in front of the id in the iObject header and are taken from a live object
+		const iObject* prototypeObject = &prototype;
+		const types::usize headerByteSize = (const types::u8*)&prototypeObject->GetID() - (const types::u8*)prototypeObject;
+		// Restored elements are destroyed through the factory like inserted ones, so they're counted as created here
+		for (types::usize i = 0; i < _elementCount; i++)
+		{
+			T* object = GetElementPtr((types::u32)i);
+			memcpy((void*)object, (const void*)prototypeObject, headerByteSize);
+			_context->Adopt(object);
+			WriteColumns((types::u32)i);
+		}
+
+		return types::K_TRUE;
+	}
+
+	template <typename T>
+	const T* cHashTable<T>::GetElement(types::u32 index) const
+	{
+		if (index >= _elementCount)
 			return nullptr;
 
-		return _chunks[chunkIndex][localPosition];
+		return GetElementPtr(index);
 	}
 
 	template <typename T>
 	types::u32 cHashTable<T>::AllocateChunk()
 	{
-		if (_chunkCount >= _maxChunkCount)
+		if (_chunkCount >= _allocatorDesc.maxChunkCount)
 			return 0;
 
-		const sCapabilities* caps = _context->GetSubsystem<cEngine>()->GetApplication()->GetCapabilities();
+		const sCapabilities* caps = _context->GetCapabilities();
 		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
-		_chunks[_chunkCount] = (T*)memoryAllocator->Allocate(_chunkByteSize, caps->memoryAlignment);
+		_chunks[_chunkCount] = (T*)memoryAllocator->Allocate(_allocatorDesc.chunkByteSize, caps->memoryAlignment);
+		if (_columnCount != 0)
+			_columnChunks[_chunkCount] = (types::u8*)memoryAllocator->Allocate(_columnByteSize * _objectCountPerChunk, caps->memoryAlignment);
 
 		return _chunkCount++;
 	}
@@ -196,14 +521,21 @@ namespace triton
 	template <typename T>
 	void cHashTable<T>::DeallocateChunk(types::u32 chunkIndex)
 	{
-		if (chunkIndex >= _chunkCount)
+		// Chunks are filled in order, so only the last one can be released without moving elements
+		if (chunkIndex + 1 != _chunkCount)
 			return;
 
 		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
-		memoryAllocator->Deallocate(_chunks[chunkIndex]);
+		if (chunkIndex >= _mappedChunkCount)
+			memoryAllocator->Deallocate(_chunks[chunkIndex]);
+		else
+			_mappedChunkCount = chunkIndex;
+		if (_columnChunks != nullptr)
+		{
+			memoryAllocator->Deallocate(_columnChunks[chunkIndex]);
+			_columnChunks[chunkIndex] = nullptr;
+		}
 		_chunkCount -= 1;
-
-		return _chunkCount++;
 	}
 
 	template <typename T>
@@ -222,11 +554,127 @@ namespace triton
 	}
 
 	template <typename T>
-	types::cpuword cHashTable<T>::MakeHashMask(types::usize size)
+	types::u32 cHashTable<T>::MakeHash(const cTag& key)
+	{
+		const types::u64 hash = key.GetHash();
+		const types::u32 foldedHash = (types::u32)(hash ^ (hash >> 32));
+
+		return foldedHash != 0 ? foldedHash : 1;
+	}
+
+	template <typename T>
+	types::u32 cHashTable<T>::FindSlot(const cTag& key, types::u32 hash) const
+	{
+		types::u32 slot = hash & _slotMask;
+		for (types::u32 distance = 0; ; distance++)
+		{
+			const sHashTableSlot& entry = _slots[slot];
+			if (entry.hash == 0)
+				return K_INVALID_SLOT;
+
+			// Robin Hood order: once we pass an entry closer to its home than we are to ours, the key isn't here
+			if (((slot - (entry.hash & _slotMask)) & _slotMask) < distance)
+				return K_INVALID_SLOT;
+
+			if (entry.hash == hash && key.Compare(GetElementPtr(entry.element)->GetID()) == types::K_TRUE)
+				return slot;
+
+			slot = (slot + 1) & _slotMask;
+		}
+	}
+
+	template <typename T>
+	void cHashTable<T>::InsertSlot(types::u32 hash, types::u32 element)
+	{
+		if (_elementCount * 8 > _slotCount * 7)
+			GrowSlots(_slotCount * 2);
+
+		sHashTableSlot entry;
+		entry.hash = hash;
+		entry.element = element;
+		PlaceSlot(entry);
+	}
+
+	template <typename T>
+	void cHashTable<T>::PlaceSlot(sHashTableSlot entry)
+	{
+		types::u32 slot = entry.hash & _slotMask;
+		types::u32 distance = 0;
+		while (_slots[slot].hash != 0)
+		{
+			const types::u32 entryDistance = (slot - (_slots[slot].hash & _slotMask)) & _slotMask;
+			if (entryDistance < distance)
+			{
+				std::swap(_slots[slot], entry);
+				distance = entryDistance;
+			}
+
+			slot = (slot + 1) & _slotMask;
+			distance += 1;
+		}
+
+		_slots[slot] = entry;
+	}
+
+	template <typename T>
+	void cHashTable<T>::EraseSlot(types::u32 slot)
 	{
-		unsigned int count = __lzcnt((unsigned int)size);
-		types::cpuword mask = (types::cpuword)((1 << (31 - count)) - 1);
+		if (slot == K_INVALID_SLOT)
+			return;
+
+		types::u32 next = (slot + 1) & _slotMask;
+		while (_slots[next].hash != 0 && ((next - (_slots[next].hash & _slotMask)) & _slotMask) != 0)
+		{
+			_slots[slot] = _slots[next];
+			slot = next;
+			next = (next + 1) & _slotMask;
+		}
 
-		return mask;
+		_slots[slot] = {};
+	}
+
+	template <typename T>
+	void cHashTable<T>::GrowSlots(types::usize slotCount)
+	{
+		const sCapabilities* caps = _context->GetCapabilities();
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		sHashTableSlot* oldSlots = _slots;
+		const types::usize oldSlotCount = _slotCount;
+
+		_slotCount = slotCount;
+		_slotMask = (types::u32)(_slotCount - 1);
+		_slots = (sHashTableSlot*)memoryAllocator->Allocate(_slotCount * sizeof(sHashTableSlot), caps->memoryAlignment);
+		for (types::usize i = 0; i < _slotCount; i++)
+			_slots[i] = {};
+
+		// Stored hashes make rehashing a pass over the slots without touching the elements
+		for (types::usize i = 0; i < oldSlotCount; i++)
+		{
+			if (oldSlots[i].hash != 0)
+				PlaceSlot(oldSlots[i]);
+		}
+
+		if (_mappedSlots == types::K_FALSE)
+			memoryAllocator->Deallocate(oldSlots);
+		_mappedSlots = types::K_FALSE;
+	}
+
+	template <typename T>
+	void cHashTable<T>::WriteColumns(types::u32 element)
+	{
+		if (_columnCount == 0)
+			return;
+
+		const T* object = GetElementPtr(element);
+		for (types::u32 i = 0; i < _columnCount; i++)
+			_columns[i].write(_columns[i].read, object, GetColumnPtr(_columns[i], element));
+	}
+
+	template <typename T>
+	template <typename C>
+	void cHashTable<T>::WriteColumn(sHashTableColumn::ReadFunction read, const void* object, types::u8* value)
+	{
+		*(C*)value = ((C (*)(const T&))read)(*(const T*)object);
 	}
 }
\ No newline at end of file
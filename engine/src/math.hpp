@@ -7,6 +7,7 @@
 #include "../../thirdparty/glm/glm/gtc/quaternion.hpp"
 #include "../../thirdparty/glm/glm/gtx/quaternion.hpp"
 #include "object.hpp"
+#include "hash.hpp"
 #include "types.hpp"
 
 namespace triton
@@ -170,6 +171,7 @@ namespace triton
 		virtual ~cMath() override final = default;
 
 		static types::f32 DegreesToRadians(types::f32 degrees);
-		static types::cpuword Hash(const types::u8* data, types::usize dataByteSize);
+		static types::u64 Hash(const types::u8* data, types::usize dataByteSize);
+		static constexpr types::u64 HashConstexpr(const char* data, types::usize dataByteSize) { return cHash::Compute(data, dataByteSize); }
 	};
 }
\ No newline at end of file
@@ -2,6 +2,12 @@
 
 #include <iostream>
 #include <cstdlib>
+#include <cstring>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
 #include "memory_pool.hpp"
 #include "application.hpp"
 #include "render_context.hpp"
@@ -11,42 +17,218 @@ using namespace types;
 
 namespace triton
 {
+	class cAllocatorThreadCacheOwner
+	{
+	public:
+		~cAllocatorThreadCacheOwner();
+
+		sAllocatorThreadCache* _cache = nullptr;
+	};
+
+	static thread_local cAllocatorThreadCacheOwner threadCacheOwner;
+
+	static const char* budgetNames[sMemoryAllocatorDescriptor::MAX_BUDGET_COUNT] =
+	{
+		"none", "render staging", "audio", "physics", "font", "game object"
+	};
+
+	// Counters are written by their owning thread only and read by reports, no read-modify-write needed
+	static inline void AddRelaxed(std::atomic<u64>& counter, u64 value)
+	{
+		counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+	}
+
+	// Index of the block ptr points at, or the bin's block count when ptr isn't the start of a block of the slab
+	static inline usize GetBlockIndex(const sAllocatorSlab* slab, const void* ptr)
+	{
+		const sAllocatorBin* bin = slab->_bin;
+		const usize blockOffset = (usize)ptr - (usize)slab->_blocks;
+		const usize blockIndex = blockOffset / bin->_blockSize;
+		if (blockOffset % bin->_blockSize != 0 || blockIndex >= bin->_maxBlockCount)
+			return bin->_maxBlockCount;
+
+		return blockIndex;
+	}
+
+	static inline boolean IsBlockOccupied(const sAllocatorSlab* slab, usize blockIndex)
+	{
+		return (slab->_occupancy[blockIndex >> 6].load(std::memory_order_relaxed) & (1ull << (blockIndex & 63))) != 0 ? K_TRUE : K_FALSE;
+	}
+
+#if defined(TRITON_MEMORY_DEBUG)
+	// Returns the previous state, a block that is already cached when freed again is a double free
+	static inline boolean ExchangeBlockCached(sAllocatorSlab* slab, const void* ptr, boolean cached)
+	{
+		const usize blockIndex = GetBlockIndex(slab, ptr);
+		const u64 blockMask = 1ull << (blockIndex & 63);
+		const u64 previousBits = cached == K_TRUE ?
+			slab->_cached[blockIndex >> 6].fetch_or(blockMask, std::memory_order_relaxed) :
+			slab->_cached[blockIndex >> 6].fetch_and(~blockMask, std::memory_order_relaxed);
+
+		return (previousBits & blockMask) != 0 ? K_TRUE : K_FALSE;
+	}
+#endif
+
+	cAllocatorThreadCacheOwner::~cAllocatorThreadCacheOwner()
+	{
+		if (_cache == nullptr)
+			return;
+
+		if (_cache->_allocator != nullptr)
+			_cache->_allocator->ReleaseThreadCache(_cache);
+		else
+			delete _cache;
+	}
+
 	cMemoryAllocator::~cMemoryAllocator()
 	{
-		if (_bins)
+		if (!_types.empty())
+			PrintLeakReport();
+
 		{
-			for (usize i = 0; i < MAX_BIN_COUNT; i++)
-				std::free(_bins[i]._blocks);
+			// Caches of still running threads are orphaned, their owners delete them on thread exit
+			std::lock_guard<std::mutex> lock(_mutex);
+			for (auto cache : _threadCaches)
+				cache->_allocator = nullptr;
+			_threadCaches.clear();
 		}
 
+		if (_slabs)
+		{
+			for (usize i = 0; i < _desc.maxSlabCount; i++)
+			{
+				if (_slabs[i]._blocks == nullptr)
+					continue;
+
+				UnmapSlabMemory(_slabs[i]._blocks);
+				std::free(_slabs[i]._occupancy);
+				std::free(_slabs[i]._cached);
+			}
+
+			std::free(_slabs);
+		}
+
+		if (_slabMap)
+		{
+			for (usize i = 0; i < ((usize)1 << _slabMapRootBits); i++)
+				delete _slabMap[i].load();
+
+			delete[] _slabMap;
+		}
+
+		if (_bins)
+			std::free(_bins);
+
 		if (_memSizeToBin)
 			std::free(_memSizeToBin);
+
+		for (auto& allocation : _heapAllocations)
+			DeallocateHeap(allocation.first);
 	}
 
 	void* cMemoryAllocator::Allocate(types::usize byteSize, types::usize alignment)
 	{
-		if (byteSize < MAX_ALLOCATION_BYTE_SIZE)
+		if (alignment < MIN_ALIGNMENT)
+			alignment = MIN_ALIGNMENT;
+
+		if ((alignment & (alignment - 1)) != 0)
 		{
-			sAllocatorBin* bin = _memSizeToBin[byteSize];
+			Print("Error: allocation alignment " + std::to_string(alignment) + " is not a power of two!");
+			return nullptr;
+		}
+
+		void* ptr = nullptr;
+
+		// Slabs are aligned to their size, so a block is aligned when its class size is a multiple of the alignment
+		const usize alignedByteSize = (byteSize + alignment - 1) & ~(alignment - 1);
+		if (alignment <= MAX_ALIGNMENT && alignedByteSize < MAX_ALLOCATION_BYTE_SIZE)
+		{
+			sAllocatorBin* bin = _memSizeToBin[alignedByteSize];
+			while ((bin->_blockSize & (alignment - 1)) != 0)
+				bin += 1;
 
-			for (usize i = 0; i < bin->_maxBlockCount; i++)
+			const usize binIndex = bin - _bins;
+			sAllocatorThreadCache* cache = GetThreadCache();
+			if (cache != nullptr)
 			{
-				iObject* obj = (iObject*)((u8*)bin->_blocks + bin->_blockSize * i);
+				// Fast path touches only the calling thread's magazine, shared bins are locked once per batch
+				sAllocatorMagazine& magazine = cache->_magazines[binIndex];
+				if (magazine._blockCount.load(std::memory_order_relaxed) == 0)
+					RefillMagazine(bin, binIndex, cache);
 
-				if (obj->_occupied == K_FALSE)
+				const usize blockCount = magazine._blockCount.load(std::memory_order_relaxed);
+				if (blockCount > 0)
 				{
-					obj->_occupied = K_TRUE;
-
-					return (void*)obj;
+					ptr = magazine._blocks[blockCount - 1];
+					magazine._blockCount.store(blockCount - 1, std::memory_order_relaxed);
+#if defined(TRITON_MEMORY_DEBUG)
+					ExchangeBlockCached(FindSlab(ptr), ptr, K_FALSE);
+#endif
+					AddRelaxed(magazine._allocationCount, 1);
+					AddRelaxed(magazine._requestedByteSize, byteSize);
 				}
 			}
+			else
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				ptr = AllocateBlock(bin);
+				if (ptr != nullptr)
+				{
+					bin->_allocationCount += 1;
+					bin->_requestedByteSize += byteSize;
+				}
+			}
+		}
 
-			return std::malloc(byteSize);
+		if (ptr == nullptr)
+		{
+			ptr = AllocateHeap(byteSize, alignment);
+			if (ptr != nullptr)
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_heapAllocations.insert({ ptr, byteSize });
+			}
 		}
-		else
+
+#if defined(TRITON_MEMORY_DEBUG)
+		if (((usize)ptr & (alignment - 1)) != 0)
+			Print("Error: allocation of " + std::to_string(byteSize) + " bytes is not aligned to " + std::to_string(alignment) + " bytes!");
+#endif
+
+		return ptr;
+	}
+
+	void* cMemoryAllocator::Allocate(types::usize byteSize, types::usize alignment, eMemoryBudget budget)
+	{
+		void* ptr = Allocate(byteSize, alignment);
+		if (ptr == nullptr || budget == eMemoryBudget::NONE)
+			return ptr;
+
+		// Budgets are charged with the usable size so deallocation can release the same amount without a side table
+		sAllocatorBudget& allocatorBudget = _budgets[(usize)budget];
+		const usize chargedByteSize = GetAllocationByteSize(ptr);
+		const usize budgetByteSize = allocatorBudget._byteSize.fetch_add(chargedByteSize) + chargedByteSize;
+
+		if (allocatorBudget._hardLimitByteSize > 0 && budgetByteSize > allocatorBudget._hardLimitByteSize)
 		{
-			return std::malloc(byteSize);
+			allocatorBudget._byteSize.fetch_sub(chargedByteSize);
+			allocatorBudget._failedAllocationCount.fetch_add(1);
+			Deallocate(ptr);
+
+			Print("Error: allocation of " + std::to_string(byteSize) + " bytes exceeds " + budgetNames[(usize)budget] + " memory budget of " + std::to_string(allocatorBudget._hardLimitByteSize) + " bytes!");
+			if (_desc.budgetAbortOnHardLimit == K_TRUE)
+				std::abort();
+
+			return nullptr;
 		}
+
+		usize peakByteSize = allocatorBudget._peakByteSize.load();
+		while (budgetByteSize > peakByteSize && !allocatorBudget._peakByteSize.compare_exchange_weak(peakByteSize, budgetByteSize));
+
+		if (allocatorBudget._softLimitByteSize > 0 && budgetByteSize >= allocatorBudget._softLimitByteSize && allocatorBudget._softLimitReached.exchange(K_TRUE) == K_FALSE)
+			allocatorBudget._softLimitPending.store(K_TRUE);
+
+		return ptr;
 	}
 
 	void cMemoryAllocator::Deallocate(void* ptr)
@@ -54,34 +236,161 @@ namespace triton
 		if (ptr == nullptr)
 			return;
 
-		iObject* obj = (iObject*)ptr;
-		obj->_occupied = K_FALSE;
+		sAllocatorSlab* slab = FindSlab(ptr);
+		if (slab == nullptr)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			const auto it = _heapAllocations.find(ptr);
+			if (it == _heapAllocations.end())
+			{
+				Print("Error: can't deallocate memory not owned by allocator!");
+				return;
+			}
+
+			_heapAllocations.erase(it);
+			DeallocateHeap(ptr);
+
+			return;
+		}
+
+		sAllocatorThreadCache* cache = GetThreadCache();
+		if (cache != nullptr)
+		{
+			// Occupancy bits of a block only change when the block itself is allocated or freed, so the unlocked
+			// read rejects interior pointers and blocks already returned to their slab
+			const usize blockIndex = GetBlockIndex(slab, ptr);
+			if (blockIndex == slab->_bin->_maxBlockCount || IsBlockOccupied(slab, blockIndex) == K_FALSE)
+			{
+				Print("Error: can't deallocate block that is not occupied!");
+				return;
+			}
+
+#if defined(TRITON_MEMORY_DEBUG)
+			// Cached blocks stay occupied, a second free before the magazine is flushed is caught here
+			if (ExchangeBlockCached(slab, ptr, K_TRUE) == K_TRUE)
+			{
+				Print("Error: can't deallocate block that is not occupied!");
+				return;
+			}
+#endif
+
+			const sAllocatorBin* bin = slab->_bin;
+			const usize binIndex = bin - _bins;
+			sAllocatorMagazine& magazine = cache->_magazines[binIndex];
+			// Without the debug bits only an immediate second free of the same block is cheap to catch
+			usize blockCount = magazine._blockCount.load(std::memory_order_relaxed);
+			if (blockCount > 0 && magazine._blocks[blockCount - 1] == ptr)
+			{
+				Print("Error: can't deallocate block that is not occupied!");
+				return;
+			}
+
+			if (blockCount >= bin->_batchBlockCount * 2)
+			{
+				FlushMagazine(binIndex, cache, bin->_batchBlockCount);
+				blockCount = magazine._blockCount.load(std::memory_order_relaxed);
+			}
+
+			magazine._blocks[blockCount] = ptr;
+			magazine._blockCount.store(blockCount + 1, std::memory_order_relaxed);
+
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		DeallocateBlock(slab, ptr);
 	}
 
-	void cMemoryAllocator::SetBins(usize maxBinByteSize)
+	void cMemoryAllocator::Deallocate(void* ptr, eMemoryBudget budget)
+	{
+		if (ptr != nullptr && budget != eMemoryBudget::NONE)
+		{
+			sAllocatorBudget& allocatorBudget = _budgets[(usize)budget];
+			const usize chargedByteSize = GetAllocationByteSize(ptr);
+			const usize budgetByteSize = allocatorBudget._byteSize.fetch_sub(chargedByteSize) - chargedByteSize;
+
+			// Falling back under the soft limit re-arms the notification
+			if (budgetByteSize < allocatorBudget._softLimitByteSize)
+				allocatorBudget._softLimitReached.store(K_FALSE);
+		}
+
+		Deallocate(ptr);
+	}
+
+	void cMemoryAllocator::SetBins(const sMemoryAllocatorDescriptor& desc)
 	{
 		if (_bins || _memSizeToBin)
 			return;
 
+		_desc = desc;
+		if (_desc.slabByteSize < MAX_ALLOCATION_BYTE_SIZE * 2 || (_desc.slabByteSize & (_desc.slabByteSize - 1)) != 0)
+		{
+			Print("Error: slab size must be a power of two of at least " + std::to_string(MAX_ALLOCATION_BYTE_SIZE * 2) + " bytes!");
+			_desc.slabByteSize = MAX_ALLOCATION_BYTE_SIZE * 2;
+		}
+
+		_slabShift = 0;
+		while (((usize)1 << _slabShift) < _desc.slabByteSize)
+			_slabShift += 1;
+
+		// Two-level slab map over the user address space, lookups are lock-free loads
+		const usize addressBits = CPU_ARCH == 64 ? 48 : 32;
+		const usize slabKeyBits = addressBits - _slabShift;
+		_slabMapRootBits = slabKeyBits > sAllocatorSlabMapLeaf::LEAF_BITS ? slabKeyBits - sAllocatorSlabMapLeaf::LEAF_BITS : 0;
+		_slabMap = new std::atomic<sAllocatorSlabMapLeaf*>[(usize)1 << _slabMapRootBits]();
+
 		_bins = (sAllocatorBin*)std::malloc(MAX_BIN_COUNT * sizeof(sAllocatorBin));
 		_memSizeToBin = (sAllocatorBin**)std::malloc(MAX_ALLOCATION_BYTE_SIZE * sizeof(sAllocatorBin*));
+		_slabs = (sAllocatorSlab*)std::malloc(_desc.maxSlabCount * sizeof(sAllocatorSlab));
 
+		// Size classes: 8-byte steps up to 128, 16-byte steps up to 256, then four classes per power of two,
+		// every class from 320 bytes is a multiple of 64 so cache-line aligned requests don't skip classes
 		static const usize blockSizes[MAX_BIN_COUNT] =
 		{
-			0, 512, 1024, 1536, 2048, 2560, 3072, 3584, 4096, 4608, 5120,
-			5632, 6144, 6656, 7168, 7680, 8192, 8704, 9216, 9728, 10240,
-			10752, 11264, 11776, 12288, 12800, 13312, 13824, 14336, 14848,
-			15360, 15872, 16384, 16896, 17408, 17920, 18432, 18944, 19456,
-			19968, 20480, 20992, 21504, 22016, 22528, 23040, 23552, 24064,
-			24576, 25088, 25600, 26112, 26624, 27136, 27648, 28160, 28672,
-			29184, 29696, 30208, 30720, 31232, 31744, 32256, 32768
+			8, 16, 24, 32, 40, 48, 56, 64, 72, 80, 88, 96, 104, 112, 120, 128,
+			144, 160, 176, 192, 208, 224, 240, 256,
+			320, 384, 448, 512,
+			640, 768, 896, 1024,
+			1280, 1536, 1792, 2048,
+			2560, 3072, 3584, 4096,
+			5120, 6144, 7168, 8192,
+			10240, 12288, 14336, 16384,
+			20480, 24576, 28672, 32768
 		};
 
 		for (usize i = 0; i < MAX_BIN_COUNT; i++)
 		{
-			_bins[i]._blockSize = blockSizes[i];
-			_bins[i]._maxBlockCount = maxBinByteSize / _bins[i]._blockSize;
-			_bins[i]._blocks = std::malloc(maxBinByteSize);
+			sAllocatorBin& bin = _bins[i];
+			bin._blockSize = blockSizes[i];
+			bin._maxBlockCount = _desc.slabByteSize / bin._blockSize;
+			bin._batchBlockCount = MAGAZINE_BATCH_BYTE_SIZE / bin._blockSize;
+			if (bin._batchBlockCount > MAX_MAGAZINE_BLOCK_COUNT / 2)
+				bin._batchBlockCount = MAX_MAGAZINE_BLOCK_COUNT / 2;
+			if (bin._batchBlockCount == 0)
+				bin._batchBlockCount = 1;
+			bin._occupiedBlockCount = 0;
+			bin._slabCount = 0;
+			bin._availableSlabs = nullptr;
+			bin._peakOccupiedBlockCount = 0;
+			bin._allocationCount = 0;
+			bin._requestedByteSize = 0;
+		}
+
+		_freeSlabs = nullptr;
+		for (usize i = _desc.maxSlabCount; i > 0; i--)
+		{
+			_slabs[i - 1]._blocks = nullptr;
+			_slabs[i - 1]._occupancy = nullptr;
+			_slabs[i - 1]._cached = nullptr;
+			_slabs[i - 1]._next = _freeSlabs;
+			_freeSlabs = &_slabs[i - 1];
+		}
+
+		for (usize i = 0; i < sMemoryAllocatorDescriptor::MAX_BUDGET_COUNT; i++)
+		{
+			_budgets[i]._hardLimitByteSize = _desc.budgetByteSizes[i];
+			_budgets[i]._softLimitByteSize = (usize)((f32)_desc.budgetByteSizes[i] * _desc.budgetSoftLimit);
 		}
 
 		for (usize i = 0; i < MAX_ALLOCATION_BYTE_SIZE; i++)
@@ -93,4 +402,770 @@ namespace triton
 			_memSizeToBin[i] = &_bins[index];
 		}
 	}
+
+	std::vector<sAllocatorBinReport> cMemoryAllocator::GetBinReports() const
+	{
+		std::vector<sAllocatorBinReport> reports;
+
+		if (_bins == nullptr)
+			return reports;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		reports.reserve(MAX_BIN_COUNT);
+		for (usize i = 0; i < MAX_BIN_COUNT; i++)
+		{
+			const sAllocatorBin& bin = _bins[i];
+
+			sAllocatorBinReport report;
+			report.blockSize = bin._blockSize;
+			report.slabCount = bin._slabCount;
+			report.occupiedBlockCount = bin._occupiedBlockCount;
+			report.peakOccupiedBlockCount = bin._peakOccupiedBlockCount;
+			report.allocationCount = bin._allocationCount;
+			report.requestedByteSize = bin._requestedByteSize;
+
+			// Blocks held in thread magazines are occupied in their bin but free for their thread, so they're
+			// left out of the report. Allocation counters live in the magazines.
+			for (const auto cache : _threadCaches)
+			{
+				const sAllocatorMagazine& magazine = cache->_magazines[i];
+				report.occupiedBlockCount -= magazine._blockCount.load(std::memory_order_relaxed);
+				report.allocationCount += magazine._allocationCount.load(std::memory_order_relaxed);
+				report.requestedByteSize += magazine._requestedByteSize.load(std::memory_order_relaxed);
+			}
+
+			report.wastedByteSize = (report.allocationCount * bin._blockSize) - report.requestedByteSize;
+			if (report.allocationCount > 0)
+				report.internalFragmentation = (f32)report.wastedByteSize / (f32)(report.allocationCount * bin._blockSize);
+
+			reports.push_back(report);
+		}
+
+		return reports;
+	}
+
+	void cMemoryAllocator::PrintBinReports() const
+	{
+		const std::vector<sAllocatorBinReport> reports = GetBinReports();
+
+		for (const auto& report : reports)
+		{
+			if (report.allocationCount == 0)
+				continue;
+
+			Print(
+				"Bin " + std::to_string(report.blockSize) +
+				": slabs " + std::to_string(report.slabCount) +
+				", occupied " + std::to_string(report.occupiedBlockCount) +
+				", peak " + std::to_string(report.peakOccupiedBlockCount) +
+				", allocations " + std::to_string(report.allocationCount) +
+				", wasted " + std::to_string(report.wastedByteSize) + " bytes" +
+				", fragmentation " + std::to_string(report.internalFragmentation * 100.0f) + "%"
+			);
+		}
+	}
+
+	u32 cMemoryAllocator::RegisterType(const std::string& type)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const auto it = _typeIndices.find(type);
+		if (it != _typeIndices.end())
+			return it->second;
+
+		if (_types.size() >= MAX_TYPE_COUNT)
+		{
+			Print("Error: can't track allocations of type '" + type + "', too many types!");
+			return K_INVALID_TYPE;
+		}
+
+		const u32 typeIndex = (u32)_types.size();
+		_types.push_back({});
+		_types.back()._name = type;
+		_typeIndices.insert({ type, typeIndex });
+
+		return typeIndex;
+	}
+
+	void cMemoryAllocator::RecordTypeAllocation(u32 typeIndex, usize byteSize, const void* object, const cTag& id)
+	{
+		if (typeIndex >= MAX_TYPE_COUNT)
+			return;
+
+		sAllocatorThreadCache* cache = GetThreadCache();
+		if (cache != nullptr)
+		{
+			sAllocatorTypeCounters& counters = cache->_types[typeIndex];
+			AddRelaxed(counters._allocationCount, 1);
+			AddRelaxed(counters._allocatedByteSize, byteSize);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_types[typeIndex]._allocationCount += 1;
+			_types[typeIndex]._allocatedByteSize += byteSize;
+		}
+
+#if defined(TRITON_MEMORY_DEBUG)
+		if (object != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			sAllocatorTrackedObject& trackedObject = _trackedObjects[object];
+			trackedObject._typeIndex = typeIndex;
+			trackedObject._id = id;
+		}
+#else
+		(void)object;
+		(void)id;
+#endif
+	}
+
+	void cMemoryAllocator::RecordTypeDeallocation(u32 typeIndex, usize byteSize, const void* object)
+	{
+		if (typeIndex >= MAX_TYPE_COUNT)
+			return;
+
+		sAllocatorThreadCache* cache = GetThreadCache();
+		if (cache != nullptr)
+		{
+			sAllocatorTypeCounters& counters = cache->_types[typeIndex];
+			AddRelaxed(counters._deallocationCount, 1);
+			AddRelaxed(counters._deallocatedByteSize, byteSize);
+		}
+		else
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_types[typeIndex]._deallocationCount += 1;
+			_types[typeIndex]._deallocatedByteSize += byteSize;
+		}
+
+#if defined(TRITON_MEMORY_DEBUG)
+		if (object != nullptr)
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_trackedObjects.erase(object);
+		}
+#else
+		(void)object;
+#endif
+	}
+
+	// Containers that swap-remove move-construct their last element into the hole, the tracked object follows it
+	void cMemoryAllocator::RecordTypeRelocation(u32 typeIndex, const void* source, const void* destination)
+	{
+		if (typeIndex >= MAX_TYPE_COUNT)
+			return;
+
+#if defined(TRITON_MEMORY_DEBUG)
+		if (source == nullptr || destination == nullptr || source == destination)
+			return;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		const auto it = _trackedObjects.find(source);
+		if (it == _trackedObjects.end())
+			return;
+
+		const sAllocatorTrackedObject trackedObject = it->second;
+		_trackedObjects.erase(it);
+		_trackedObjects[destination] = trackedObject;
+#else
+		(void)source;
+		(void)destination;
+#endif
+	}
+
+	std::vector<sAllocatorTypeReport> cMemoryAllocator::GetTypeReports() const
+	{
+		std::vector<sAllocatorTypeReport> reports;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const auto time = std::chrono::steady_clock::now();
+		const f32 elapsedSeconds = std::chrono::duration<f32>(time - _typeReportTime).count();
+		_typeReportTime = time;
+
+		reports.reserve(_types.size());
+		for (usize i = 0; i < _types.size(); i++)
+		{
+			sAllocatorType& type = _types[i];
+
+			u64 allocationCount = type._allocationCount;
+			u64 deallocationCount = type._deallocationCount;
+			u64 allocatedByteSize = type._allocatedByteSize;
+			u64 deallocatedByteSize = type._deallocatedByteSize;
+			for (const auto cache : _threadCaches)
+			{
+				const sAllocatorTypeCounters& counters = cache->_types[i];
+				allocationCount += counters._allocationCount.load(std::memory_order_relaxed);
+				deallocationCount += counters._deallocationCount.load(std::memory_order_relaxed);
+				allocatedByteSize += counters._allocatedByteSize.load(std::memory_order_relaxed);
+				deallocatedByteSize += counters._deallocatedByteSize.load(std::memory_order_relaxed);
+			}
+
+			sAllocatorTypeReport report;
+			report.type = type._name;
+			report.allocationCount = allocationCount;
+			report.liveCount = allocationCount > deallocationCount ? allocationCount - deallocationCount : 0;
+			report.liveByteSize = allocatedByteSize > deallocatedByteSize ? allocatedByteSize - deallocatedByteSize : 0;
+
+			// Peaks are sampled when reports are taken, counters stay thread-local in between
+			if (report.liveCount > type._peakLiveCount)
+				type._peakLiveCount = report.liveCount;
+			if (report.liveByteSize > type._peakLiveByteSize)
+				type._peakLiveByteSize = report.liveByteSize;
+			report.peakLiveCount = type._peakLiveCount;
+			report.peakLiveByteSize = type._peakLiveByteSize;
+
+			if (elapsedSeconds > 0.0f)
+				report.allocationRate = (f32)(allocationCount - type._reportedAllocationCount) / elapsedSeconds;
+			type._reportedAllocationCount = allocationCount;
+
+			reports.push_back(report);
+		}
+
+		return reports;
+	}
+
+	void cMemoryAllocator::PrintTypeReports() const
+	{
+		const std::vector<sAllocatorTypeReport> reports = GetTypeReports();
+
+		for (const auto& report : reports)
+		{
+			if (report.allocationCount == 0)
+				continue;
+
+			Print(
+				"Type " + report.type +
+				": live " + std::to_string(report.liveCount) +
+				", live " + std::to_string(report.liveByteSize) + " bytes" +
+				", peak " + std::to_string(report.peakLiveCount) +
+				", peak " + std::to_string(report.peakLiveByteSize) + " bytes" +
+				", allocations " + std::to_string(report.allocationCount) +
+				", rate " + std::to_string(report.allocationRate) + "/s"
+			);
+		}
+	}
+
+	void cMemoryAllocator::PrintLeakReport() const
+	{
+		const std::vector<sAllocatorTypeReport> reports = GetTypeReports();
+
+		for (const auto& report : reports)
+		{
+			if (report.liveCount > 0)
+				Print("Leak: " + std::to_string(report.liveCount) + " objects of type '" + report.type + "', " + std::to_string(report.liveByteSize) + " bytes");
+		}
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		for (const auto& trackedObject : _trackedObjects)
+		{
+			const cTag& id = trackedObject.second._id;
+			Print("Leak: object '" + std::string((const char*)id.GetData().data(), id.GetByteSize()) + "' of type '" + _types[trackedObject.second._typeIndex]._name + "'");
+		}
+	}
+
+	std::string cMemoryAllocator::GetReportJson() const
+	{
+		const std::vector<sAllocatorBinReport> binReports = GetBinReports();
+		const std::vector<sAllocatorTypeReport> typeReports = GetTypeReports();
+
+		std::string json = "{\"mappedByteSize\":" + std::to_string(_mappedByteSize) + ",\"bins\":[";
+		for (usize i = 0; i < binReports.size(); i++)
+		{
+			const sAllocatorBinReport& report = binReports[i];
+			json += std::string(i > 0 ? "," : "") +
+				"{\"blockSize\":" + std::to_string(report.blockSize) +
+				",\"slabCount\":" + std::to_string(report.slabCount) +
+				",\"occupiedBlockCount\":" + std::to_string(report.occupiedBlockCount) +
+				",\"peakOccupiedBlockCount\":" + std::to_string(report.peakOccupiedBlockCount) +
+				",\"allocationCount\":" + std::to_string(report.allocationCount) +
+				",\"requestedByteSize\":" + std::to_string(report.requestedByteSize) +
+				",\"wastedByteSize\":" + std::to_string(report.wastedByteSize) +
+				",\"internalFragmentation\":" + std::to_string(report.internalFragmentation) + "}";
+		}
+
+		json += "],\"types\":[";
+		for (usize i = 0; i < typeReports.size(); i++)
+		{
+			const sAllocatorTypeReport& report = typeReports[i];
+			json += std::string(i > 0 ? "," : "") +
+				"{\"type\":\"" + report.type + "\"" +
+				",\"liveCount\":" + std::to_string(report.liveCount) +
+				",\"liveByteSize\":" + std::to_string(report.liveByteSize) +
+				",\"peakLiveCount\":" + std::to_string(report.peakLiveCount) +
+				",\"peakLiveByteSize\":" + std::to_string(report.peakLiveByteSize) +
+				",\"allocationCount\":" + std::to_string(report.allocationCount) +
+				",\"allocationRate\":" + std::to_string(report.allocationRate) + "}";
+		}
+		json += "]}";
+
+		return json;
+	}
+
+	sMemoryBudgetReport cMemoryAllocator::GetBudgetReport(eMemoryBudget budget) const
+	{
+		const sAllocatorBudget& allocatorBudget = _budgets[(usize)budget];
+
+		sMemoryBudgetReport report;
+		report.budget = budget;
+		report.byteSize = allocatorBudget._byteSize.load(std::memory_order_relaxed);
+		report.peakByteSize = allocatorBudget._peakByteSize.load(std::memory_order_relaxed);
+		report.softLimitByteSize = allocatorBudget._softLimitByteSize;
+		report.hardLimitByteSize = allocatorBudget._hardLimitByteSize;
+		report.failedAllocationCount = allocatorBudget._failedAllocationCount.load(std::memory_order_relaxed);
+
+		return report;
+	}
+
+	types::boolean cMemoryAllocator::ConsumeBudgetSoftLimit(eMemoryBudget budget)
+	{
+		return _budgets[(usize)budget]._softLimitPending.exchange(K_FALSE);
+	}
+
+	void* cMemoryAllocator::AllocateBlock(sAllocatorBin* bin)
+	{
+		sAllocatorSlab* slab = bin->_availableSlabs;
+		if (slab == nullptr)
+			slab = AllocateSlab(bin);
+
+		if (slab == nullptr)
+			return nullptr;
+
+		// Reuse a freed block first, otherwise carve the next untouched block of the slab
+		void* block = slab->_freeBlocks;
+		if (block != nullptr)
+			slab->_freeBlocks = *(void**)block;
+		else
+			block = (void*)((u8*)slab->_blocks + bin->_blockSize * slab->_carvedBlockCount++);
+
+		const usize blockIndex = ((usize)block - (usize)slab->_blocks) / bin->_blockSize;
+		slab->_occupancy[blockIndex >> 6].fetch_or(1ull << (blockIndex & 63), std::memory_order_relaxed);
+		slab->_occupiedBlockCount += 1;
+		if (slab->_occupiedBlockCount == bin->_maxBlockCount)
+			UnlinkSlab(slab);
+
+		bin->_occupiedBlockCount += 1;
+		if (bin->_occupiedBlockCount > bin->_peakOccupiedBlockCount)
+			bin->_peakOccupiedBlockCount = bin->_occupiedBlockCount;
+
+		return block;
+	}
+
+	void cMemoryAllocator::DeallocateBlock(sAllocatorSlab* slab, void* ptr)
+	{
+		sAllocatorBin* bin = slab->_bin;
+		const usize blockIndex = GetBlockIndex(slab, ptr);
+		if (blockIndex == bin->_maxBlockCount || IsBlockOccupied(slab, blockIndex) == K_FALSE)
+		{
+			Print("Error: can't deallocate block that is not occupied!");
+			return;
+		}
+
+		slab->_occupancy[blockIndex >> 6].fetch_and(~(1ull << (blockIndex & 63)), std::memory_order_relaxed);
+		*(void**)ptr = slab->_freeBlocks;
+		slab->_freeBlocks = ptr;
+
+		if (slab->_occupiedBlockCount == bin->_maxBlockCount)
+			LinkSlab(slab);
+
+		slab->_occupiedBlockCount -= 1;
+		bin->_occupiedBlockCount -= 1;
+
+		// Empty slabs stay cached for reuse until the mapped size exceeds the high-water mark
+		if (slab->_occupiedBlockCount == 0 && _mappedByteSize > _desc.highWaterMarkByteSize)
+		{
+			UnlinkSlab(slab);
+			DeallocateSlab(slab);
+		}
+	}
+
+	void* cMemoryAllocator::AllocateHeap(types::usize byteSize, types::usize alignment)
+	{
+#if defined(_WIN32)
+		return _aligned_malloc(byteSize, alignment);
+#else
+		void* ptr = nullptr;
+		if (posix_memalign(&ptr, alignment, byteSize) != 0)
+			return nullptr;
+
+		return ptr;
+#endif
+	}
+
+	void cMemoryAllocator::DeallocateHeap(void* ptr)
+	{
+#if defined(_WIN32)
+		_aligned_free(ptr);
+#else
+		std::free(ptr);
+#endif
+	}
+
+	sAllocatorSlab* cMemoryAllocator::AllocateSlab(sAllocatorBin* bin)
+	{
+		if (_freeSlabs == nullptr)
+		{
+			if (_slabLimitReported == K_FALSE)
+			{
+				Print("Warning: memory allocator slab limit reached, falling back to system heap!");
+				_slabLimitReported = K_TRUE;
+			}
+
+			return nullptr;
+		}
+
+		void* memory = MapSlabMemory();
+		if (memory == nullptr)
+			return nullptr;
+
+		const usize slabKey = (usize)memory >> _slabShift;
+		const usize rootIndex = slabKey >> sAllocatorSlabMapLeaf::LEAF_BITS;
+		if (rootIndex >= ((usize)1 << _slabMapRootBits))
+		{
+			UnmapSlabMemory(memory);
+			return nullptr;
+		}
+
+		sAllocatorSlabMapLeaf* leaf = _slabMap[rootIndex].load(std::memory_order_acquire);
+		if (leaf == nullptr)
+		{
+			leaf = new sAllocatorSlabMapLeaf();
+			_slabMap[rootIndex].store(leaf, std::memory_order_release);
+		}
+
+		sAllocatorSlab* slab = _freeSlabs;
+		_freeSlabs = slab->_next;
+
+		slab->_blocks = memory;
+		slab->_bin = bin;
+		slab->_freeBlocks = nullptr;
+		slab->_carvedBlockCount = 0;
+		slab->_occupiedBlockCount = 0;
+		slab->_occupancy = (std::atomic<u64>*)std::calloc((bin->_maxBlockCount + 63) / 64, sizeof(u64));
+#if defined(TRITON_MEMORY_DEBUG)
+		slab->_cached = (std::atomic<u64>*)std::calloc((bin->_maxBlockCount + 63) / 64, sizeof(u64));
+#endif
+		slab->_previous = nullptr;
+		slab->_next = nullptr;
+
+		LinkSlab(slab);
+		leaf->_slabs[slabKey & ((1 << sAllocatorSlabMapLeaf::LEAF_BITS) - 1)].store(slab, std::memory_order_release);
+		_mappedByteSize += _desc.slabByteSize;
+		bin->_slabCount += 1;
+
+		return slab;
+	}
+
+	void cMemoryAllocator::DeallocateSlab(sAllocatorSlab* slab)
+	{
+		const usize slabKey = (usize)slab->_blocks >> _slabShift;
+		sAllocatorSlabMapLeaf* leaf = _slabMap[slabKey >> sAllocatorSlabMapLeaf::LEAF_BITS].load(std::memory_order_relaxed);
+		leaf->_slabs[slabKey & ((1 << sAllocatorSlabMapLeaf::LEAF_BITS) - 1)].store(nullptr, std::memory_order_release);
+		UnmapSlabMemory(slab->_blocks);
+		std::free(slab->_occupancy);
+		std::free(slab->_cached);
+		_mappedByteSize -= _desc.slabByteSize;
+		slab->_bin->_slabCount -= 1;
+
+		slab->_blocks = nullptr;
+		slab->_bin = nullptr;
+		slab->_occupancy = nullptr;
+		slab->_cached = nullptr;
+		slab->_previous = nullptr;
+		slab->_next = _freeSlabs;
+		_freeSlabs = slab;
+	}
+
+	void cMemoryAllocator::LinkSlab(sAllocatorSlab* slab)
+	{
+		sAllocatorBin* bin = slab->_bin;
+
+		slab->_previous = nullptr;
+		slab->_next = bin->_availableSlabs;
+		if (bin->_availableSlabs != nullptr)
+			bin->_availableSlabs->_previous = slab;
+		bin->_availableSlabs = slab;
+	}
+
+	void cMemoryAllocator::UnlinkSlab(sAllocatorSlab* slab)
+	{
+		sAllocatorBin* bin = slab->_bin;
+
+		if (slab->_previous != nullptr)
+			slab->_previous->_next = slab->_next;
+		else
+			bin->_availableSlabs = slab->_next;
+
+		if (slab->_next != nullptr)
+			slab->_next->_previous = slab->_previous;
+
+		slab->_previous = nullptr;
+		slab->_next = nullptr;
+	}
+
+	sAllocatorSlab* cMemoryAllocator::FindSlab(const void* ptr) const
+	{
+		// Slabs are aligned to their size, so the slab base address is the lookup key
+		const usize slabKey = (usize)ptr >> _slabShift;
+		const usize rootIndex = slabKey >> sAllocatorSlabMapLeaf::LEAF_BITS;
+		if (_slabMap == nullptr || rootIndex >= ((usize)1 << _slabMapRootBits))
+			return nullptr;
+
+		const sAllocatorSlabMapLeaf* leaf = _slabMap[rootIndex].load(std::memory_order_acquire);
+		if (leaf == nullptr)
+			return nullptr;
+
+		return leaf->_slabs[slabKey & ((1 << sAllocatorSlabMapLeaf::LEAF_BITS) - 1)].load(std::memory_order_acquire);
+	}
+
+	usize cMemoryAllocator::GetAllocationByteSize(const void* ptr) const
+	{
+		const sAllocatorSlab* slab = FindSlab(ptr);
+		if (slab != nullptr)
+			return slab->_bin->_blockSize;
+
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		const auto it = _heapAllocations.find((void*)ptr);
+		if (it == _heapAllocations.end())
+			return 0;
+
+		return it->second;
+	}
+
+	void* cMemoryAllocator::MapSlabMemory()
+	{
+		const usize byteSize = _desc.slabByteSize;
+
+#if defined(_WIN32)
+		// VirtualAlloc regions are 64 KiB aligned, larger slabs need an aligned reservation
+		void* memory = VirtualAlloc(nullptr, byteSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+		if (memory == nullptr || ((usize)memory & (byteSize - 1)) == 0)
+			return memory;
+
+		VirtualFree(memory, 0, MEM_RELEASE);
+
+		for (usize attempt = 0; attempt < 8; attempt++)
+		{
+			void* region = VirtualAlloc(nullptr, byteSize * 2, MEM_RESERVE, PAGE_NOACCESS);
+			if (region == nullptr)
+				return nullptr;
+
+			void* aligned = (void*)(((usize)region + byteSize - 1) & ~(byteSize - 1));
+			VirtualFree(region, 0, MEM_RELEASE);
+
+			memory = VirtualAlloc(aligned, byteSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+			if (memory != nullptr)
+				return memory;
+		}
+
+		return nullptr;
+#else
+		u8* region = (u8*)mmap(nullptr, byteSize * 2, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (region == (u8*)MAP_FAILED)
+			return nullptr;
+
+		u8* aligned = (u8*)(((usize)region + byteSize - 1) & ~(byteSize - 1));
+		const usize headByteSize = aligned - region;
+		const usize tailByteSize = byteSize - headByteSize;
+		if (headByteSize > 0)
+			munmap(region, headByteSize);
+		if (tailByteSize > 0)
+			munmap(aligned + byteSize, tailByteSize);
+
+#if defined(MADV_HUGEPAGE)
+		if (_desc.hugePages == K_TRUE)
+			madvise(aligned, byteSize, MADV_HUGEPAGE);
+#endif
+
+		return (void*)aligned;
+#endif
+	}
+
+	void cMemoryAllocator::UnmapSlabMemory(void* memory)
+	{
+#if defined(_WIN32)
+		VirtualFree(memory, 0, MEM_RELEASE);
+#else
+		munmap(memory, _desc.slabByteSize);
+#endif
+	}
+
+	sAllocatorThreadCache* cMemoryAllocator::GetThreadCache()
+	{
+		sAllocatorThreadCache* cache = threadCacheOwner._cache;
+		if (cache != nullptr)
+		{
+			if (cache->_allocator == this)
+				return cache;
+			else if (cache->_allocator != nullptr)
+				return nullptr;
+
+			delete cache;
+		}
+
+		cache = new sAllocatorThreadCache();
+		cache->_allocator = this;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_threadCaches.push_back(cache);
+		}
+		threadCacheOwner._cache = cache;
+
+		return cache;
+	}
+
+	void cMemoryAllocator::ReleaseThreadCache(sAllocatorThreadCache* cache)
+	{
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+
+			for (usize i = 0; i < MAX_BIN_COUNT; i++)
+			{
+				sAllocatorMagazine& magazine = cache->_magazines[i];
+				const usize blockCount = magazine._blockCount.load(std::memory_order_relaxed);
+				for (usize j = 0; j < blockCount; j++)
+				{
+					sAllocatorSlab* slab = FindSlab(magazine._blocks[j]);
+#if defined(TRITON_MEMORY_DEBUG)
+					ExchangeBlockCached(slab, magazine._blocks[j], K_FALSE);
+#endif
+					DeallocateBlock(slab, magazine._blocks[j]);
+				}
+
+				_bins[i]._allocationCount += magazine._allocationCount.load(std::memory_order_relaxed);
+				_bins[i]._requestedByteSize += magazine._requestedByteSize.load(std::memory_order_relaxed);
+			}
+
+			for (usize i = 0; i < _types.size(); i++)
+			{
+				const sAllocatorTypeCounters& counters = cache->_types[i];
+				_types[i]._allocationCount += counters._allocationCount.load(std::memory_order_relaxed);
+				_types[i]._deallocationCount += counters._deallocationCount.load(std::memory_order_relaxed);
+				_types[i]._allocatedByteSize += counters._allocatedByteSize.load(std::memory_order_relaxed);
+				_types[i]._deallocatedByteSize += counters._deallocatedByteSize.load(std::memory_order_relaxed);
+			}
+
+			for (usize i = 0; i < _threadCaches.size(); i++)
+			{
+				if (_threadCaches[i] == cache)
+				{
+					_threadCaches[i] = _threadCaches.back();
+					_threadCaches.pop_back();
+					break;
+				}
+			}
+		}
+
+		if (threadCacheOwner._cache == cache)
+			threadCacheOwner._cache = nullptr;
+
+		delete cache;
+	}
+
+	void cMemoryAllocator::RefillMagazine(sAllocatorBin* bin, usize binIndex, sAllocatorThreadCache* cache)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		sAllocatorMagazine& magazine = cache->_magazines[binIndex];
+		usize blockCount = magazine._blockCount.load(std::memory_order_relaxed);
+		while (blockCount < bin->_batchBlockCount)
+		{
+			void* block = AllocateBlock(bin);
+			if (block == nullptr)
+				break;
+
+#if defined(TRITON_MEMORY_DEBUG)
+			ExchangeBlockCached(FindSlab(block), block, K_TRUE);
+#endif
+			magazine._blocks[blockCount++] = block;
+		}
+		magazine._blockCount.store(blockCount, std::memory_order_relaxed);
+	}
+
+	void cMemoryAllocator::FlushMagazine(usize binIndex, sAllocatorThreadCache* cache, usize blockCount)
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+
+		sAllocatorMagazine& magazine = cache->_magazines[binIndex];
+		const usize cachedBlockCount = magazine._blockCount.load(std::memory_order_relaxed);
+		if (blockCount > cachedBlockCount)
+			blockCount = cachedBlockCount;
+
+		// Return the oldest blocks and keep the recently freed, cache-warm ones in the magazine
+		for (usize i = 0; i < blockCount; i++)
+		{
+			sAllocatorSlab* slab = FindSlab(magazine._blocks[i]);
+#if defined(TRITON_MEMORY_DEBUG)
+			ExchangeBlockCached(slab, magazine._blocks[i], K_FALSE);
+#endif
+			DeallocateBlock(slab, magazine._blocks[i]);
+		}
+
+		memmove(&magazine._blocks[0], &magazine._blocks[blockCount], (cachedBlockCount - blockCount) * sizeof(void*));
+		magazine._blockCount.store(cachedBlockCount - blockCount, std::memory_order_relaxed);
+	}
+
+	void cLinearAllocator::SetMemory(void* memory, usize byteSize)
+	{
+		_memory = (u8*)memory;
+		_byteSize = memory != nullptr ? byteSize : 0;
+		_offset = 0;
+		_peakOffset = 0;
+	}
+
+	void* cLinearAllocator::Allocate(usize byteSize, usize alignment)
+	{
+		if (alignment < cMemoryAllocator::MIN_ALIGNMENT)
+			alignment = cMemoryAllocator::MIN_ALIGNMENT;
+
+		const usize address = ((usize)_memory + _offset + alignment - 1) & ~(alignment - 1);
+		const usize offset = address - (usize)_memory + byteSize;
+		if (offset > _byteSize)
+		{
+			Print("Error: linear allocator of " + std::to_string(_byteSize) + " bytes is out of memory!");
+			return nullptr;
+		}
+
+		_offset = offset;
+		if (_offset > _peakOffset)
+			_peakOffset = _offset;
+
+		return (void*)address;
+	}
+
+	void cLinearAllocator::Rewind(usize marker)
+	{
+		if (marker <= _offset)
+			_offset = marker;
+	}
+
+	cFrameAllocator::cFrameAllocator(cMemoryAllocator* allocator, usize frameByteSize, usize frameCount, usize stackByteSize) : _allocator(allocator)
+	{
+		_frameCount = frameCount;
+		if (_frameCount == 0)
+			_frameCount = 1;
+		else if (_frameCount > MAX_FRAME_COUNT)
+			_frameCount = MAX_FRAME_COUNT;
+
+		for (usize i = 0; i < _frameCount; i++)
+			_frames[i].SetMemory(_allocator->Allocate(frameByteSize, cMemoryAllocator::MAX_ALIGNMENT), frameByteSize);
+		_stack.SetMemory(_allocator->Allocate(stackByteSize, cMemoryAllocator::MAX_ALIGNMENT), stackByteSize);
+	}
+
+	cFrameAllocator::~cFrameAllocator()
+	{
+		_allocator->Deallocate(_stack.GetMemory());
+		for (usize i = 0; i < _frameCount; i++)
+			_allocator->Deallocate(_frames[i].GetMemory());
+	}
+
+	void cFrameAllocator::BeginFrame()
+	{
+		// Data written during the previous frames stays valid until its buffer comes around again
+		_frameIndex = (_frameIndex + 1) % _frameCount;
+		_frames[_frameIndex].Reset();
+	}
 }
\ No newline at end of file
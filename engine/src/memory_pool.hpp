@@ -3,37 +3,310 @@
 #pragma once
 
 #include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <chrono>
 #include "object.hpp"
+#include "tag.hpp"
 #include "types.hpp"
 
 namespace triton
 {
-	class cContext;
-	
+    class cContext;
+    class cAllocatorThreadCacheOwner;
+    struct sAllocatorBin;
+    struct sAllocatorThreadCache;
+
+    enum class eMemoryBudget
+    {
+        NONE,
+        RENDER_STAGING,
+        AUDIO,
+        PHYSICS,
+        FONT,
+        GAME_OBJECT
+    };
+
+    struct sMemoryAllocatorDescriptor
+    {
+        static constexpr types::usize MAX_BUDGET_COUNT = 6;
+
+        types::usize slabByteSize = 64 * 1024;
+        types::usize maxSlabCount = 4096;
+        types::usize highWaterMarkByteSize = 32 * 1024 * 1024;
+        types::boolean hugePages = types::K_FALSE;
+        types::usize budgetByteSizes[MAX_BUDGET_COUNT] = {};
+        types::f32 budgetSoftLimit = 0.8f;
+        types::boolean budgetAbortOnHardLimit = types::K_FALSE;
+    };
+
+    struct sMemoryBudgetReport
+    {
+        eMemoryBudget budget = eMemoryBudget::NONE;
+        types::usize byteSize = 0;
+        types::usize peakByteSize = 0;
+        types::usize softLimitByteSize = 0;
+        types::usize hardLimitByteSize = 0;
+        types::u64 failedAllocationCount = 0;
+    };
+
+    struct sAllocatorSlab
+    {
+        void* _blocks = nullptr;
+        sAllocatorBin* _bin = nullptr;
+        void* _freeBlocks = nullptr;
+        types::usize _carvedBlockCount = 0;
+        types::usize _occupiedBlockCount = 0;
+        // Bits are written under the allocator lock, the magazine free path reads them without it
+        std::atomic<types::u64>* _occupancy = nullptr;
+        // TRITON_MEMORY_DEBUG only: blocks sitting in a thread magazine, which stay set in _occupancy
+        std::atomic<types::u64>* _cached = nullptr;
+        sAllocatorSlab* _previous = nullptr;
+        sAllocatorSlab* _next = nullptr;
+    };
+
+    struct sAllocatorSlabMapLeaf
+    {
+        static constexpr types::usize LEAF_BITS = 16;
+
+        std::atomic<sAllocatorSlab*> _slabs[1 << LEAF_BITS];
+    };
+
     struct sAllocatorBin
     {
         types::usize _blockSize = 0;
         types::usize _maxBlockCount = 0;
-        void* _blocks = nullptr;
+        types::usize _batchBlockCount = 0;
+        types::usize _occupiedBlockCount = 0;
+        types::usize _slabCount = 0;
+        sAllocatorSlab* _availableSlabs = nullptr;
+        types::usize _peakOccupiedBlockCount = 0;
+        types::u64 _allocationCount = 0;
+        types::u64 _requestedByteSize = 0;
+    };
+
+    struct sAllocatorBinReport
+    {
+        types::usize blockSize = 0;
+        types::usize slabCount = 0;
+        types::usize occupiedBlockCount = 0;
+        types::usize peakOccupiedBlockCount = 0;
+        types::u64 allocationCount = 0;
+        types::u64 requestedByteSize = 0;
+        types::u64 wastedByteSize = 0;
+        types::f32 internalFragmentation = 0.0f;
+    };
+
+    struct sAllocatorBudget
+    {
+        std::atomic<types::usize> _byteSize = { 0 };
+        std::atomic<types::usize> _peakByteSize = { 0 };
+        std::atomic<types::u64> _failedAllocationCount = { 0 };
+        std::atomic<types::boolean> _softLimitReached = { types::K_FALSE };
+        std::atomic<types::boolean> _softLimitPending = { types::K_FALSE };
+        types::usize _softLimitByteSize = 0;
+        types::usize _hardLimitByteSize = 0;
+    };
+
+    struct sAllocatorTypeCounters
+    {
+        std::atomic<types::u64> _allocationCount = { 0 };
+        std::atomic<types::u64> _deallocationCount = { 0 };
+        std::atomic<types::u64> _allocatedByteSize = { 0 };
+        std::atomic<types::u64> _deallocatedByteSize = { 0 };
+    };
+
+    struct sAllocatorType
+    {
+        std::string _name;
+        types::u64 _allocationCount = 0;
+        types::u64 _deallocationCount = 0;
+        types::u64 _allocatedByteSize = 0;
+        types::u64 _deallocatedByteSize = 0;
+        types::u64 _peakLiveCount = 0;
+        types::u64 _peakLiveByteSize = 0;
+        types::u64 _reportedAllocationCount = 0;
+    };
+
+    struct sAllocatorTypeReport
+    {
+        std::string type;
+        types::u64 liveCount = 0;
+        types::u64 liveByteSize = 0;
+        types::u64 peakLiveCount = 0;
+        types::u64 peakLiveByteSize = 0;
+        types::u64 allocationCount = 0;
+        types::f32 allocationRate = 0.0f;
+    };
+
+    struct sAllocatorTrackedObject
+    {
+        types::u32 _typeIndex = 0;
+        cTag _id;
     };
 
     class cMemoryAllocator
     {
+        friend class cAllocatorThreadCacheOwner;
+
     public:
-        static constexpr types::usize MAX_BIN_COUNT = 64 + 1;
+        static constexpr types::usize MAX_BIN_COUNT = 52;
         static constexpr types::usize MAX_ALLOCATION_BYTE_SIZE = 32 * 1024;
+        static constexpr types::usize MIN_ALIGNMENT = 8;
+        static constexpr types::usize MAX_ALIGNMENT = 4096;
+        static constexpr types::usize MAX_MAGAZINE_BLOCK_COUNT = 64;
+        static constexpr types::usize MAGAZINE_BATCH_BYTE_SIZE = 16 * 1024;
+        static constexpr types::usize MAX_TYPE_COUNT = 256;
+        static constexpr types::u32 K_INVALID_TYPE = 0xFFFFFFFF;
 
     public:
         explicit cMemoryAllocator() = default;
         virtual ~cMemoryAllocator();
 
         void* Allocate(types::usize byteSize, types::usize alignment);
+        void* Allocate(types::usize byteSize, types::usize alignment, eMemoryBudget budget);
         void Deallocate(void* ptr);
+        void Deallocate(void* ptr, eMemoryBudget budget);
+
+        void SetBins(const sMemoryAllocatorDescriptor& desc);
 
-        void SetBins(types::usize maxBinByteSize);
+        std::vector<sAllocatorBinReport> GetBinReports() const;
+        void PrintBinReports() const;
+
+        types::u32 RegisterType(const std::string& type);
+        void RecordTypeAllocation(types::u32 typeIndex, types::usize byteSize, const void* object, const cTag& id);
+        void RecordTypeDeallocation(types::u32 typeIndex, types::usize byteSize, const void* object);
+        void RecordTypeRelocation(types::u32 typeIndex, const void* source, const void* destination);
+        std::vector<sAllocatorTypeReport> GetTypeReports() const;
+        void PrintTypeReports() const;
+        void PrintLeakReport() const;
+        std::string GetReportJson() const;
+
+        sMemoryBudgetReport GetBudgetReport(eMemoryBudget budget) const;
+        types::boolean ConsumeBudgetSoftLimit(eMemoryBudget budget);
+
+        inline types::usize GetMappedByteSize() const { return _mappedByteSize; }
+
+    private:
+        void* AllocateBlock(sAllocatorBin* bin);
+        void DeallocateBlock(sAllocatorSlab* slab, void* ptr);
+        void* AllocateHeap(types::usize byteSize, types::usize alignment);
+        void DeallocateHeap(void* ptr);
+        sAllocatorSlab* AllocateSlab(sAllocatorBin* bin);
+        void DeallocateSlab(sAllocatorSlab* slab);
+        void LinkSlab(sAllocatorSlab* slab);
+        void UnlinkSlab(sAllocatorSlab* slab);
+        sAllocatorSlab* FindSlab(const void* ptr) const;
+        types::usize GetAllocationByteSize(const void* ptr) const;
+        void* MapSlabMemory();
+        void UnmapSlabMemory(void* memory);
+        sAllocatorThreadCache* GetThreadCache();
+        void ReleaseThreadCache(sAllocatorThreadCache* cache);
+        void RefillMagazine(sAllocatorBin* bin, types::usize binIndex, sAllocatorThreadCache* cache);
+        void FlushMagazine(types::usize binIndex, sAllocatorThreadCache* cache, types::usize blockCount);
 
     private:
+        sMemoryAllocatorDescriptor _desc = {};
+        types::usize _slabShift = 0;
+        types::usize _slabMapRootBits = 0;
+        types::usize _mappedByteSize = 0;
+        types::boolean _slabLimitReported = types::K_FALSE;
         sAllocatorBin* _bins = nullptr;
         sAllocatorBin** _memSizeToBin = nullptr;
+        sAllocatorSlab* _slabs = nullptr;
+        sAllocatorSlab* _freeSlabs = nullptr;
+        std::atomic<sAllocatorSlabMapLeaf*>* _slabMap = nullptr;
+        std::unordered_map<void*, types::usize> _heapAllocations;
+        std::vector<sAllocatorThreadCache*> _threadCaches;
+        sAllocatorBudget _budgets[sMemoryAllocatorDescriptor::MAX_BUDGET_COUNT];
+        mutable std::vector<sAllocatorType> _types;
+        std::unordered_map<std::string, types::u32> _typeIndices;
+        std::unordered_map<const void*, sAllocatorTrackedObject> _trackedObjects;
+        mutable std::chrono::steady_clock::time_point _typeReportTime = std::chrono::steady_clock::now();
+        mutable std::mutex _mutex;
+    };
+
+    struct sAllocatorMagazine
+    {
+        // Written by the owning thread only, atomic so reports can read it from other threads
+        std::atomic<types::usize> _blockCount = { 0 };
+        void* _blocks[cMemoryAllocator::MAX_MAGAZINE_BLOCK_COUNT] = {};
+        std::atomic<types::u64> _allocationCount = { 0 };
+        std::atomic<types::u64> _requestedByteSize = { 0 };
+    };
+
+    struct sAllocatorThreadCache
+    {
+        cMemoryAllocator* _allocator = nullptr;
+        sAllocatorMagazine _magazines[cMemoryAllocator::MAX_BIN_COUNT];
+        sAllocatorTypeCounters _types[cMemoryAllocator::MAX_TYPE_COUNT];
+    };
+
+    class cLinearAllocator
+    {
+    public:
+        explicit cLinearAllocator() = default;
+        ~cLinearAllocator() = default;
+
+        cLinearAllocator(const cLinearAllocator& rhs) = delete;
+        cLinearAllocator& operator=(const cLinearAllocator& rhs) = delete;
+
+        void SetMemory(void* memory, types::usize byteSize);
+        void* Allocate(types::usize byteSize, types::usize alignment);
+        void Rewind(types::usize marker);
+        inline void Reset() { _offset = 0; }
+
+        inline void* GetMemory() const { return _memory; }
+        inline types::usize GetMarker() const { return _offset; }
+        inline types::usize GetByteSize() const { return _byteSize; }
+        inline types::usize GetPeakByteSize() const { return _peakOffset; }
+
+    private:
+        types::u8* _memory = nullptr;
+        types::usize _byteSize = 0;
+        types::usize _offset = 0;
+        types::usize _peakOffset = 0;
+    };
+
+    class cStackAllocatorScope
+    {
+    public:
+        explicit cStackAllocatorScope(cLinearAllocator* stack) : _stack(stack), _marker(stack->GetMarker()) {}
+        ~cStackAllocatorScope() { _stack->Rewind(_marker); }
+
+        cStackAllocatorScope(const cStackAllocatorScope& rhs) = delete;
+        cStackAllocatorScope& operator=(const cStackAllocatorScope& rhs) = delete;
+
+        inline void* Allocate(types::usize byteSize, types::usize alignment) { return _stack->Allocate(byteSize, alignment); }
+
+    private:
+        cLinearAllocator* _stack = nullptr;
+        types::usize _marker = 0;
+    };
+
+    class cFrameAllocator
+    {
+    public:
+        static constexpr types::usize MAX_FRAME_COUNT = 3;
+
+    public:
+        explicit cFrameAllocator(cMemoryAllocator* allocator, types::usize frameByteSize, types::usize frameCount, types::usize stackByteSize);
+        ~cFrameAllocator();
+
+        void BeginFrame();
+
+        inline void* Allocate(types::usize byteSize, types::usize alignment) { return _frames[_frameIndex].Allocate(byteSize, alignment); }
+        inline cLinearAllocator* GetFrame() { return &_frames[_frameIndex]; }
+        inline cLinearAllocator* GetStack() { return &_stack; }
+        inline types::usize GetFrameCount() const { return _frameCount; }
+
+    private:
+        cMemoryAllocator* _allocator = nullptr;
+        types::usize _frameCount = 0;
+        types::usize _frameIndex = 0;
+        cLinearAllocator _frames[MAX_FRAME_COUNT];
+        cLinearAllocator _stack;
     };
 }
\ No newline at end of file
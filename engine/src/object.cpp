@@ -1,5 +1,9 @@
 // object.cpp
 
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 #include "object.hpp"
 #include "event_manager.hpp"
 #include "context.hpp"
@@ -8,21 +12,120 @@ using namespace types;
 
 namespace triton
 {
-    cTag cIdentifier::Generate(const std::string& seed)
+    struct sIdentifierInternTable
     {
-        static usize counter = 0;
+        std::mutex mutex;
+        std::unordered_map<cTag, u32, sTagHasher> keys;
+        std::vector<cTag> tags = std::vector<cTag>(1, cTag());
+    };
 
-        cTag tag;
+    static sIdentifierInternTable& GetIdentifierInternTable()
+    {
+        static sIdentifierInternTable table;
+
+        return table;
+    }
+
+    static std::atomic<u64> identifierSequence = { 0 };
+
+    cTag cIdentifier::Generate(const char* typeName)
+    {
+        return Generate(typeName, identifierSequence.fetch_add(1, std::memory_order_relaxed));
+    }
+
+    cTag cIdentifier::Generate(const char* typeName, u64 value)
+    {
+        // The sequence alone keeps identifiers unique, so the type name is cut to whatever room the digits leave
+        u8 digits[20] = {};
+        usize digitCount = 0;
+        do
+        {
+            digits[digitCount++] = (u8)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+
+        // Written straight into a zeroed tag so the bytes are copied and hashed once
+        cTag id;
+        const usize maxNameByteSize = cTag::kMaxTagByteSize - 1 - digitCount;
+        usize byteSize = 0;
+        while (byteSize < maxNameByteSize && typeName[byteSize] != 0)
+        {
+            id._data[byteSize] = (u8)typeName[byteSize];
+            byteSize += 1;
+        }
+        while (digitCount > 0)
+            id._data[byteSize++] = digits[--digitCount];
+        id._byteSize = byteSize;
+        id._hash = cHash::ComputeRuntime(&id._data[0], byteSize);
+
+        return id;
+    }
+
+    u64 cIdentifier::ReserveSequence(usize count)
+    {
+        return identifierSequence.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    u64 cIdentifier::GetSequence()
+    {
+        return identifierSequence.load(std::memory_order_relaxed);
+    }
 
-        const std::string& idStr = seed + std::to_string(counter++);
-        tag.CopyChars((const u8*)idStr.c_str(), idStr.size());
+    // Identifiers loaded from elsewhere were generated below sequence, new ones must start past them
+    void cIdentifier::AdvanceSequence(u64 sequence)
+    {
+        u64 current = identifierSequence.load(std::memory_order_relaxed);
+        while (current < sequence && identifierSequence.compare_exchange_weak(current, sequence, std::memory_order_relaxed) == K_FALSE)
+            ;
+    }
+
+    u32 cIdentifier::Intern(const cTag& id)
+    {
+        sIdentifierInternTable& table = GetIdentifierInternTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        const auto it = table.keys.find(id);
+        if (it != table.keys.end())
+            return it->second;
+
+        const u32 key = (u32)table.tags.size();
+        table.tags.push_back(id);
+        table.keys.insert({ id, key });
+
+        return key;
+    }
+
+    u32 cIdentifier::FindInterned(const cTag& id)
+    {
+        sIdentifierInternTable& table = GetIdentifierInternTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        const auto it = table.keys.find(id);
 
-        return tag;
+        return it != table.keys.end() ? it->second : K_INVALID_KEY;
     }
 
-    iObject::~iObject()
+    cTag cIdentifier::GetInterned(u32 key)
     {
-        delete _identifier;
+        sIdentifierInternTable& table = GetIdentifierInternTable();
+        std::lock_guard<std::mutex> lock(table.mutex);
+
+        return key < table.tags.size() ? table.tags[key] : cTag();
+    }
+
+    u32 cTypeRegistry::Register(const char* typeName)
+    {
+        static std::atomic<u32> typeCount = { 1 };
+
+        const u32 index = typeCount.fetch_add(1, std::memory_order_relaxed);
+        if (index >= MAX_TYPE_COUNT)
+        {
+            Print("Error: can't register type '" + std::string(typeName) + "', type registry is full!");
+
+            return 0;
+        }
+
+        return index;
     }
 
     void iObject::Subscribe(eEventType type, EventFunction&& function)
@@ -8,6 +8,7 @@
 #include "event_types.hpp"
 #include "memory_pool.hpp"
 #include "tag.hpp"
+#include "hash.hpp"
 #include "types.hpp"
 
 namespace triton
@@ -16,17 +17,54 @@ namespace triton
 	class cDataBuffer;
 	class cGameObject;
 
-	using ClassType = std::string;
+	// Hash of the class name, known at compile time
+	using ClassType = types::u32;
 
 	#define TRITON_OBJECT(typeName) \
 		public: \
-			static ClassType GetTypeStatic() { return #typeName; } \
+			static constexpr ClassType GetTypeStatic() { return (ClassType)cHash::Compute(#typeName, sizeof(#typeName) - 1); } \
+			static constexpr const char* GetTypeNameStatic() { return #typeName; } \
 			virtual ClassType GetType() const override { return GetTypeStatic(); } \
+			virtual const char* GetTypeName() const override { return GetTypeNameStatic(); } \
 
+	// Hands out dense per-type indices so cContext can keep subsystems and factories in flat arrays.
+	// Index 0 is never handed out to a type and stays empty, types past MAX_TYPE_COUNT fall back to it.
+	class cTypeRegistry
+	{
+	public:
+		static constexpr types::usize MAX_TYPE_COUNT = 256;
+
+	public:
+		static types::u32 Register(const char* typeName);
+	};
+
+	template <typename T>
+	class cTypeIndex
+	{
+	public:
+		static const types::u32 value;
+	};
+
+	template <typename T>
+	const types::u32 cTypeIndex<T>::value = cTypeRegistry::Register(T::GetTypeNameStatic());
+
+	// Generate builds "<typeName><sequence>" from one atomic counter straight into the tag bytes,
+	// batches reserve a whole sequence range with one atomic add and build each tag from it.
+	// Intern optionally maps a readable identifier to a compact key once, key 0 is never handed out.
 	class cIdentifier
 	{
 	public:
-		static cTag Generate(const std::string& seed);
+		static constexpr types::u32 K_INVALID_KEY = 0;
+
+	public:
+		static cTag Generate(const char* typeName);
+		static cTag Generate(const char* typeName, types::u64 sequence);
+		static types::u64 ReserveSequence(types::usize count);
+		static types::u64 GetSequence();
+		static void AdvanceSequence(types::u64 sequence);
+		static types::u32 Intern(const cTag& id);
+		static types::u32 FindInterned(const cTag& id);
+		static cTag GetInterned(types::u32 key);
 	};
 
 	class iObject;
@@ -42,7 +80,6 @@ namespace triton
 		friend class cIdVector;
 		template <typename T>
 		friend class cFactory;
-		friend class cMemoryAllocator;
 
 	public:
 		explicit iObject(cContext* context) : _context(context) {}
@@ -52,6 +89,7 @@ namespace triton
 		iObject& operator=(const iObject& rhs) = delete;
 
 		virtual ClassType GetType() const = 0;
+		virtual const char* GetTypeName() const = 0;
 
 		void Subscribe(eEventType type, EventFunction&& function);
 		void Unsubscribe(eEventType type);
@@ -63,8 +101,6 @@ namespace triton
 
 	protected:
 		cContext* _context = nullptr;
-		types::boolean _occupied = types::K_FALSE;
-		types::s64 _allocatorIndex = 0;
 		cTag _id;
 	};
 }
\ No newline at end of file
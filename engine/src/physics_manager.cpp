@@ -38,7 +38,7 @@ namespace triton
 
     cPhysics::cPhysics(cContext* context) :
         iObject(context),
-        _allocator(new cPhysicsAllocator()),
+        _allocator(new cPhysicsAllocator(context->GetMemoryAllocator())),
         _error(new cPhysicsError()),
         _cpuDispatcher(new cPhysicsCPUDispatcher()),
         _simulationEvent(new cPhysicsSimulationEvent())
@@ -49,6 +49,11 @@ namespace triton
         _actors = _context->Create<cCache<cPhysicsActor>>(context, caps->maxPhysicsActorCount);
         _controllers = _context->Create<cCache<cPhysicsController>>(context, caps->maxPhysicsControllerCount);
 
+        // Simulate only needs these three members, the columns keep it from pulling whole actors
+        _actorTypeColumn = _actors->AddColumn<eCategory>([](const cPhysicsActor& actor) { return actor.GetActorType(); });
+        _actorColumn = _actors->AddColumn<PxActor*>([](const cPhysicsActor& actor) { return actor.GetActor(); });
+        _actorGameObjectColumn = _actors->AddColumn<cGameObject*>([](const cPhysicsActor& actor) { return actor.GetGameObject(); });
+
         _foundation = PxCreateFoundation(PX_PHYSICS_VERSION, *_allocator, *_error);
         if (_foundation == nullptr)
         {
@@ -228,31 +233,34 @@ namespace triton
 
     void cPhysics::Simulate()
     {
-        const cPhysicsActor* actorsArray = _actors->GetElements();
-
-        for (usize i = 0; i < _actors->GetElementCount(); i++)
+        for (u32 chunk = 0; chunk < _actors->GetChunkCount(); chunk++)
         {
-            auto& actor = actorsArray[i];
+            const sHashTableColumnSpan<eCategory> actorTypes = _actors->GetColumn<eCategory>(_actorTypeColumn, chunk);
+            const sHashTableColumnSpan<PxActor*> pxActors = _actors->GetColumn<PxActor*>(_actorColumn, chunk);
+            const sHashTableColumnSpan<cGameObject*> gameObjects = _actors->GetColumn<cGameObject*>(_actorGameObjectColumn, chunk);
 
-            if (actor.GetActorType() != eCategory::PHYSICS_ACTOR_DYNAMIC)
-                continue;
+            for (usize i = 0; i < actorTypes.count; i++)
+            {
+                if (actorTypes.data[i] != eCategory::PHYSICS_ACTOR_DYNAMIC)
+                    continue;
 
-            cTransform* transform = actor.GetGameObject()->GetTransform();
-            const PxActor* pxActor = actor.GetActor();
+                cTransform* transform = gameObjects.data[i]->GetTransform();
+                const PxActor* pxActor = pxActors.data[i];
 
-            const PxTransform actorTransform = ((PxRigidDynamic*)pxActor)->getGlobalPose();
-            const cQuaternion q = cQuaternion(
-                actorTransform.q.w,
-                actorTransform.q.x,
-                actorTransform.q.y,
-                actorTransform.q.z
-            );
-            const cVector3 actorEuler = q.EulerAngles();
+                const PxTransform actorTransform = ((PxRigidDynamic*)pxActor)->getGlobalPose();
+                const cQuaternion q = cQuaternion(
+                    actorTransform.q.w,
+                    actorTransform.q.x,
+                    actorTransform.q.y,
+                    actorTransform.q.z
+                );
+                const cVector3 actorEuler = q.EulerAngles();
 
-            {
-                std::lock_guard<std::mutex> lock(_mutex);
-                transform->SetPosition(cVector3(actorTransform.p.y, actorTransform.p.x, actorTransform.p.z));
-                transform->SetRotation(cVector3(actorEuler.GetY(), actorEuler.GetX(), actorEuler.GetZ()));
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    transform->SetPosition(cVector3(actorTransform.p.y, actorTransform.p.x, actorTransform.p.z));
+                    transform->SetRotation(cVector3(actorEuler.GetY(), actorEuler.GetX(), actorEuler.GetZ()));
+                }
             }
         }
 
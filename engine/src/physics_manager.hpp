@@ -10,6 +10,7 @@
 #include "../../thirdparty/glm/glm/glm.hpp"
 #include "category.hpp"
 #include "cache.hpp"
+#include "memory_pool.hpp"
 #include "log.hpp"
 
 namespace physx
@@ -33,15 +34,23 @@ namespace triton
 
     class cPhysicsAllocator : public physx::PxAllocatorCallback
     {
+    public:
+        explicit cPhysicsAllocator(cMemoryAllocator* memoryAllocator) : _memoryAllocator(memoryAllocator) {}
+
+    private:
+        // PhysX requires 16-byte aligned allocations
         virtual void* allocate(size_t size, const char* typeName, const char* filename, int line) override final
         {
-            return malloc(size);
+            return _memoryAllocator->Allocate(size, 16, eMemoryBudget::PHYSICS);
         }
 
         virtual void deallocate(void* ptr) override final
         {
-            free(ptr);
+            _memoryAllocator->Deallocate(ptr, eMemoryBudget::PHYSICS);
         }
+
+    private:
+        cMemoryAllocator* _memoryAllocator = nullptr;
     };
 
     class cPhysicsError : public physx::PxErrorCallback
@@ -185,5 +194,8 @@ namespace triton
         cCache<cPhysicsMaterial>* _materials;
         cCache<cPhysicsActor>* _actors;
         cCache<cPhysicsController>* _controllers;
+        types::u32 _actorTypeColumn = 0;
+        types::u32 _actorColumn = 0;
+        types::u32 _actorGameObjectColumn = 0;
     };
 }
\ No newline at end of file
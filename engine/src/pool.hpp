@@ -0,0 +1,161 @@
+// pool.hpp
+
+#pragma once
+
+#include <utility>
+#include "object.hpp"
+#include "context.hpp"
+#include "handle.hpp"
+#include "log.hpp"
+#include "memory_pool.hpp"
+#include "types.hpp"
+
+namespace triton
+{
+	struct sPoolSlot
+	{
+		types::u32 dense = 0;
+		types::u32 generation = 1;
+	};
+
+	template <typename T>
+	class cPool : public iObject
+	{
+		TRITON_OBJECT(cPool)
+
+	public:
+		static constexpr types::u32 K_INVALID_SLOT = 0xFFFFFFFF;
+
+	public:
+		explicit cPool(cContext* context, types::usize maxElementCount, types::usize alignment);
+		virtual ~cPool() override final;
+
+		template <typename... Args>
+		cHandle Create(Args&&... args);
+		T* Find(const cHandle& handle) const;
+		void Destroy(const cHandle& handle);
+		void Clear();
+
+		inline types::boolean IsAlive(const cHandle& handle) const { return Find(handle) != nullptr; }
+		inline T* GetElement(types::u32 index) const { return index < _elementCount ? &_objects[index] : nullptr; }
+		inline cHandle GetHandle(types::u32 index) const { return cHandle(_denseToSlot[index], _slots[_denseToSlot[index]].generation); }
+		inline types::usize GetElementCount() const { return _elementCount; }
+		inline types::usize GetMaxElementCount() const { return _maxElementCount; }
+
+	private:
+		types::usize _maxElementCount = 0;
+		types::usize _elementCount = 0;
+		types::usize _slotCount = 0;
+		types::u32 _freeSlot = K_INVALID_SLOT;
+		T* _objects = nullptr;
+		types::u32* _denseToSlot = nullptr;
+		sPoolSlot* _slots = nullptr;
+	};
+
+	template <typename T>
+	cPool<T>::cPool(cContext* context, types::usize maxElementCount, types::usize alignment) : iObject(context)
+	{
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+
+		if (alignment < alignof(T))
+			alignment = alignof(T);
+
+		_maxElementCount = maxElementCount;
+		_objects = (T*)memoryAllocator->Allocate(_maxElementCount * sizeof(T), alignment);
+		_denseToSlot = (types::u32*)memoryAllocator->Allocate(_maxElementCount * sizeof(types::u32), alignment);
+		_slots = (sPoolSlot*)memoryAllocator->Allocate(_maxElementCount * sizeof(sPoolSlot), alignment);
+	}
+
+	template <typename T>
+	cPool<T>::~cPool()
+	{
+		Clear();
+
+		cMemoryAllocator* memoryAllocator = _context->GetMemoryAllocator();
+		memoryAllocator->Deallocate(_slots);
+		memoryAllocator->Deallocate(_denseToSlot);
+		memoryAllocator->Deallocate(_objects);
+	}
+
+	template <typename T>
+	template <typename... Args>
+	cHandle cPool<T>::Create(Args&&... args)
+	{
+		types::u32 slotIndex = _freeSlot;
+		if (slotIndex != K_INVALID_SLOT)
+		{
+			_freeSlot = _slots[slotIndex].dense;
+		}
+		else
+		{
+			if (_slotCount >= _maxElementCount)
+			{
+				Print("Error: pool of type '" + std::string(T::GetTypeNameStatic()) + "' is full!");
+				return cHandle();
+			}
+
+			slotIndex = (types::u32)_slotCount++;
+			_slots[slotIndex] = {};
+		}
+
+		const types::u32 denseIndex = (types::u32)_elementCount++;
+		_slots[slotIndex].dense = denseIndex;
+		_denseToSlot[denseIndex] = slotIndex;
+
+		new (&_objects[denseIndex]) T(std::forward<Args>(args)...);
+
+		return cHandle(slotIndex, _slots[slotIndex].generation);
+	}
+
+	template <typename T>
+	T* cPool<T>::Find(const cHandle& handle) const
+	{
+		if (handle.idx >= _slotCount)
+			return nullptr;
+
+		const sPoolSlot& slot = _slots[handle.idx];
+		if (slot.generation != handle.generation)
+			return nullptr;
+
+		return &_objects[slot.dense];
+	}
+
+	template <typename T>
+	void cPool<T>::Destroy(const cHandle& handle)
+	{
+		if (Find(handle) == nullptr)
+			return;
+
+		sPoolSlot& slot = _slots[handle.idx];
+		const types::u32 denseIndex = slot.dense;
+		const types::u32 lastIndex = (types::u32)_elementCount - 1;
+
+		// Keep objects contiguous by moving the last one into the hole and patching its slot
+		_objects[denseIndex].~T();
+		if (denseIndex != lastIndex)
+		{
+			new (&_objects[denseIndex]) T(std::move(_objects[lastIndex]));
+			_objects[lastIndex].~T();
+
+			const types::u32 lastSlotIndex = _denseToSlot[lastIndex];
+			_slots[lastSlotIndex].dense = denseIndex;
+			_denseToSlot[denseIndex] = lastSlotIndex;
+		}
+		_elementCount -= 1;
+
+		// Generation 0 is reserved for null handles
+		slot.generation += 1;
+		if (slot.generation == 0)
+			slot.generation = 1;
+		slot.dense = _freeSlot;
+		_freeSlot = handle.idx;
+	}
+
+	template <typename T>
+	void cPool<T>::Clear()
+	{
+		// Through the context, so the factory sees objects it created
+		while (_elementCount > 0)
+			_context->Destroy<T>(this, GetHandle((types::u32)_elementCount - 1));
+	}
+}
\ No newline at end of file
@@ -0,0 +1,328 @@
+// range_allocator.cpp
+
+#include "range_allocator.hpp"
+#include "log.hpp"
+
+using namespace types;
+
+namespace triton
+{
+	static u32 FindLastSet(usize value)
+	{
+		u32 index = 0;
+		while (value >>= 1)
+			index += 1;
+
+		return index;
+	}
+
+	static u32 FindFirstSet(u32 value)
+	{
+		u32 index = 0;
+		while ((value & 1) == 0)
+		{
+			value >>= 1;
+			index += 1;
+		}
+
+		return index;
+	}
+
+	cRangeAllocator::cRangeAllocator(usize byteSize, usize granularity)
+	{
+		_granularity = granularity > 0 ? granularity : 1;
+		_byteSize = byteSize - (byteSize % _granularity);
+
+		Reset();
+	}
+
+	u32 cRangeAllocator::Allocate(usize byteSize, void* userData)
+	{
+		byteSize = ((byteSize + _granularity - 1) / _granularity) * _granularity;
+		if (byteSize == 0)
+			byteSize = _granularity;
+
+		const u32 block = FindFreeBlock(byteSize);
+		if (block == K_INVALID_RANGE)
+			return K_INVALID_RANGE;
+
+		RemoveFreeBlock(block);
+
+		// Split the tail off into a new free block, headers are indices so growing the array keeps them valid
+		if (_blocks[block]._byteSize - byteSize >= _granularity)
+		{
+			const u32 remainder = CreateBlock();
+			sRangeBlock& blockRef = _blocks[block];
+			sRangeBlock& remainderRef = _blocks[remainder];
+			remainderRef._offset = blockRef._offset + byteSize;
+			remainderRef._byteSize = blockRef._byteSize - byteSize;
+			remainderRef._previousPhysical = block;
+			remainderRef._nextPhysical = blockRef._nextPhysical;
+			if (blockRef._nextPhysical != K_INVALID_RANGE)
+				_blocks[blockRef._nextPhysical]._previousPhysical = remainder;
+			blockRef._nextPhysical = remainder;
+			blockRef._byteSize = byteSize;
+			InsertFreeBlock(remainder);
+		}
+
+		sRangeBlock& blockRef = _blocks[block];
+		blockRef._free = K_FALSE;
+		blockRef._userData = userData;
+		_usedByteSize += blockRef._byteSize;
+
+		return block;
+	}
+
+	void cRangeAllocator::Deallocate(u32 range)
+	{
+		if (range >= _blocks.size() || _blocks[range]._free == K_TRUE)
+		{
+			Print("Error: can't deallocate range not owned by range allocator!");
+			return;
+		}
+
+		u32 block = range;
+		_blocks[block]._free = K_TRUE;
+		_blocks[block]._userData = nullptr;
+		_usedByteSize -= _blocks[block]._byteSize;
+
+		const u32 previous = _blocks[block]._previousPhysical;
+		if (previous != K_INVALID_RANGE && _blocks[previous]._free == K_TRUE)
+		{
+			RemoveFreeBlock(previous);
+			_blocks[previous]._byteSize += _blocks[block]._byteSize;
+			_blocks[previous]._nextPhysical = _blocks[block]._nextPhysical;
+			if (_blocks[block]._nextPhysical != K_INVALID_RANGE)
+				_blocks[_blocks[block]._nextPhysical]._previousPhysical = previous;
+			ReleaseBlock(block);
+			block = previous;
+		}
+
+		const u32 next = _blocks[block]._nextPhysical;
+		if (next != K_INVALID_RANGE && _blocks[next]._free == K_TRUE)
+		{
+			RemoveFreeBlock(next);
+			_blocks[block]._byteSize += _blocks[next]._byteSize;
+			_blocks[block]._nextPhysical = _blocks[next]._nextPhysical;
+			if (_blocks[next]._nextPhysical != K_INVALID_RANGE)
+				_blocks[_blocks[next]._nextPhysical]._previousPhysical = block;
+			ReleaseBlock(next);
+		}
+
+		InsertFreeBlock(block);
+	}
+
+	void cRangeAllocator::Reset()
+	{
+		_blocks.clear();
+		_unusedBlocks.clear();
+		_usedByteSize = 0;
+		_flBitmap = 0;
+		for (u32 i = 0; i < FL_COUNT; i++)
+		{
+			_slBitmaps[i] = 0;
+			for (u32 j = 0; j < SL_COUNT; j++)
+				_freeHeads[i][j] = K_INVALID_RANGE;
+		}
+
+		_firstBlock = CreateBlock();
+		sRangeBlock& block = _blocks[_firstBlock];
+		block._offset = 0;
+		block._byteSize = _byteSize;
+		InsertFreeBlock(_firstBlock);
+	}
+
+	void cRangeAllocator::Reset(std::vector<void*>& userData)
+	{
+		// Owners of the ranges still in use are handed back so they can drop their handles
+		for (u32 block = _firstBlock; block != K_INVALID_RANGE; block = _blocks[block]._nextPhysical)
+		{
+			if (_blocks[block]._free == K_FALSE)
+				userData.push_back(_blocks[block]._userData);
+		}
+
+		Reset();
+	}
+
+	usize cRangeAllocator::Compact(usize maxMoveByteSize, std::vector<sRangeMove>& moves)
+	{
+		// Slide used blocks down into the free block in front of them, free space bubbles towards the end
+		// and merges on the way. Each call moves at most maxMoveByteSize bytes so the pass can be spread over frames.
+		usize movedByteSize = 0;
+		u32 block = _firstBlock;
+		while (block != K_INVALID_RANGE && movedByteSize < maxMoveByteSize)
+		{
+			const u32 used = _blocks[block]._nextPhysical;
+			if (_blocks[block]._free == K_FALSE || used == K_INVALID_RANGE || _blocks[used]._free == K_TRUE)
+			{
+				block = _blocks[block]._nextPhysical;
+				continue;
+			}
+
+			RemoveFreeBlock(block);
+
+			sRangeBlock& freeRef = _blocks[block];
+			sRangeBlock& usedRef = _blocks[used];
+
+			sRangeMove move;
+			move.range = used;
+			move.srcOffset = usedRef._offset;
+			move.dstOffset = freeRef._offset;
+			move.byteSize = usedRef._byteSize;
+			move.userData = usedRef._userData;
+			moves.push_back(move);
+			movedByteSize += move.byteSize;
+
+			// Swap the physical order of the two blocks
+			const u32 previous = freeRef._previousPhysical;
+			const u32 next = usedRef._nextPhysical;
+			usedRef._offset = freeRef._offset;
+			freeRef._offset = usedRef._offset + usedRef._byteSize;
+			usedRef._previousPhysical = previous;
+			usedRef._nextPhysical = block;
+			freeRef._previousPhysical = used;
+			freeRef._nextPhysical = next;
+			if (previous != K_INVALID_RANGE)
+				_blocks[previous]._nextPhysical = used;
+			else
+				_firstBlock = used;
+			if (next != K_INVALID_RANGE)
+				_blocks[next]._previousPhysical = block;
+
+			if (next != K_INVALID_RANGE && _blocks[next]._free == K_TRUE)
+			{
+				RemoveFreeBlock(next);
+				freeRef._byteSize += _blocks[next]._byteSize;
+				freeRef._nextPhysical = _blocks[next]._nextPhysical;
+				if (freeRef._nextPhysical != K_INVALID_RANGE)
+					_blocks[freeRef._nextPhysical]._previousPhysical = block;
+				ReleaseBlock(next);
+			}
+
+			InsertFreeBlock(block);
+		}
+
+		return movedByteSize;
+	}
+
+	void cRangeAllocator::Map(usize byteSize, u32& fl, u32& sl) const
+	{
+		const usize unitCount = byteSize / _granularity;
+		if (unitCount < SL_COUNT)
+		{
+			fl = 0;
+			sl = (u32)unitCount;
+			return;
+		}
+
+		const u32 lastSet = FindLastSet(unitCount);
+		fl = lastSet - (SL_BITS - 1);
+		sl = (u32)(unitCount >> (lastSet - SL_BITS)) & (SL_COUNT - 1);
+		if (fl >= FL_COUNT)
+		{
+			fl = FL_COUNT - 1;
+			sl = SL_COUNT - 1;
+		}
+	}
+
+	u32 cRangeAllocator::FindFreeBlock(usize byteSize)
+	{
+		// Round up to the next list boundary so any block in the found list is large enough
+		usize unitCount = byteSize / _granularity;
+		if (unitCount >= SL_COUNT)
+			unitCount += ((usize)1 << (FindLastSet(unitCount) - SL_BITS)) - 1;
+
+		u32 fl = 0;
+		u32 sl = 0;
+		Map(unitCount * _granularity, fl, sl);
+
+		u32 slBitmap = _slBitmaps[fl] & (~0u << sl);
+		if (slBitmap == 0)
+		{
+			const u32 flBitmap = fl + 1 < FL_COUNT ? _flBitmap & (~0u << (fl + 1)) : 0;
+			if (flBitmap == 0)
+				return K_INVALID_RANGE;
+
+			fl = FindFirstSet(flBitmap);
+			slBitmap = _slBitmaps[fl];
+		}
+		sl = FindFirstSet(slBitmap);
+
+		const u32 block = _freeHeads[fl][sl];
+		if (_blocks[block]._byteSize < byteSize)
+			return K_INVALID_RANGE;
+
+		return block;
+	}
+
+	void cRangeAllocator::InsertFreeBlock(u32 block)
+	{
+		u32 fl = 0;
+		u32 sl = 0;
+		Map(_blocks[block]._byteSize, fl, sl);
+
+		sRangeBlock& blockRef = _blocks[block];
+		blockRef._free = K_TRUE;
+		blockRef._previousFree = K_INVALID_RANGE;
+		blockRef._nextFree = _freeHeads[fl][sl];
+		if (blockRef._nextFree != K_INVALID_RANGE)
+			_blocks[blockRef._nextFree]._previousFree = block;
+		_freeHeads[fl][sl] = block;
+		_flBitmap |= 1u << fl;
+		_slBitmaps[fl] |= 1u << sl;
+	}
+
+	void cRangeAllocator::RemoveFreeBlock(u32 block)
+	{
+		u32 fl = 0;
+		u32 sl = 0;
+		Map(_blocks[block]._byteSize, fl, sl);
+
+		const sRangeBlock& blockRef = _blocks[block];
+		if (blockRef._previousFree != K_INVALID_RANGE)
+			_blocks[blockRef._previousFree]._nextFree = blockRef._nextFree;
+		else
+			_freeHeads[fl][sl] = blockRef._nextFree;
+		if (blockRef._nextFree != K_INVALID_RANGE)
+			_blocks[blockRef._nextFree]._previousFree = blockRef._previousFree;
+
+		if (_freeHeads[fl][sl] == K_INVALID_RANGE)
+		{
+			_slBitmaps[fl] &= ~(1u << sl);
+			if (_slBitmaps[fl] == 0)
+				_flBitmap &= ~(1u << fl);
+		}
+	}
+
+	u32 cRangeAllocator::CreateBlock()
+	{
+		u32 block = K_INVALID_RANGE;
+		if (!_unusedBlocks.empty())
+		{
+			block = _unusedBlocks.back();
+			_unusedBlocks.pop_back();
+		}
+		else
+		{
+			block = (u32)_blocks.size();
+			_blocks.push_back({});
+		}
+
+		sRangeBlock& blockRef = _blocks[block];
+		blockRef = {};
+		blockRef._previousPhysical = K_INVALID_RANGE;
+		blockRef._nextPhysical = K_INVALID_RANGE;
+		blockRef._previousFree = K_INVALID_RANGE;
+		blockRef._nextFree = K_INVALID_RANGE;
+
+		return block;
+	}
+
+	void cRangeAllocator::ReleaseBlock(u32 block)
+	{
+		// Released headers read as free so a stale range can't be deallocated twice
+		_blocks[block]._free = K_TRUE;
+		_blocks[block]._byteSize = 0;
+		_unusedBlocks.push_back(block);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+// range_allocator.hpp
+
+#pragma once
+
+#include <vector>
+#include "types.hpp"
+
+namespace triton
+{
+	struct sRangeBlock
+	{
+		types::usize _offset = 0;
+		types::usize _byteSize = 0;
+		types::u32 _previousPhysical = 0;
+		types::u32 _nextPhysical = 0;
+		types::u32 _previousFree = 0;
+		types::u32 _nextFree = 0;
+		types::boolean _free = types::K_FALSE;
+		void* _userData = nullptr;
+	};
+
+	struct sRangeMove
+	{
+		types::u32 range = 0;
+		types::usize srcOffset = 0;
+		types::usize dstOffset = 0;
+		types::usize byteSize = 0;
+		void* userData = nullptr;
+	};
+
+	// Two-level segregated fit allocator over an offset space, block headers live outside the managed memory
+	// so it can sub-allocate GPU buffers
+	class cRangeAllocator
+	{
+	public:
+		static constexpr types::u32 K_INVALID_RANGE = 0xFFFFFFFF;
+		static constexpr types::u32 SL_BITS = 4;
+		static constexpr types::u32 SL_COUNT = 1 << SL_BITS;
+		static constexpr types::u32 FL_COUNT = 32;
+
+	public:
+		explicit cRangeAllocator(types::usize byteSize, types::usize granularity);
+		~cRangeAllocator() = default;
+
+		types::u32 Allocate(types::usize byteSize, void* userData);
+		void Deallocate(types::u32 range);
+		void Reset();
+		void Reset(std::vector<void*>& userData);
+		types::usize Compact(types::usize maxMoveByteSize, std::vector<sRangeMove>& moves);
+
+		inline types::usize GetOffset(types::u32 range) const { return _blocks[range]._offset; }
+		inline types::usize GetByteSize(types::u32 range) const { return _blocks[range]._byteSize; }
+		inline types::usize GetCapacity() const { return _byteSize; }
+		inline types::usize GetUsedByteSize() const { return _usedByteSize; }
+
+	private:
+		void Map(types::usize byteSize, types::u32& fl, types::u32& sl) const;
+		types::u32 FindFreeBlock(types::usize byteSize);
+		void InsertFreeBlock(types::u32 block);
+		void RemoveFreeBlock(types::u32 block);
+		types::u32 CreateBlock();
+		void ReleaseBlock(types::u32 block);
+
+	private:
+		types::usize _byteSize = 0;
+		types::usize _granularity = 0;
+		types::usize _usedByteSize = 0;
+		types::u32 _firstBlock = K_INVALID_RANGE;
+		types::u32 _flBitmap = 0;
+		types::u32 _slBitmaps[FL_COUNT] = {};
+		types::u32 _freeHeads[FL_COUNT][SL_COUNT] = {};
+		std::vector<sRangeBlock> _blocks;
+		std::vector<types::u32> _unusedBlocks;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,154 @@
+// snapshot.cpp
+
+#include <fstream>
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include "snapshot.hpp"
+#include "log.hpp"
+
+using namespace types;
+
+namespace triton
+{
+	static inline u64 AlignSnapshotOffset(u64 offset)
+	{
+		return (offset + cSnapshot::K_SNAPSHOT_ALIGNMENT - 1) & ~(u64)(cSnapshot::K_SNAPSHOT_ALIGNMENT - 1);
+	}
+
+	static void WritePadding(std::ofstream& outputFile, u64 offset)
+	{
+		static const char zeros[cSnapshot::K_SNAPSHOT_ALIGNMENT] = {};
+
+		const u64 paddingByteSize = AlignSnapshotOffset(offset) - offset;
+		if (paddingByteSize != 0)
+			outputFile.write(&zeros[0], paddingByteSize);
+	}
+
+	cMappedFile::~cMappedFile()
+	{
+		Close();
+	}
+
+	boolean cMappedFile::Open(const std::string& path)
+	{
+		Close();
+
+#if defined(_WIN32)
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return K_FALSE;
+
+		LARGE_INTEGER byteSize = {};
+		GetFileSizeEx(file, &byteSize);
+		HANDLE mapping = byteSize.QuadPart != 0 ? CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr) : nullptr;
+		void* data = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0) : nullptr;
+		if (data == nullptr)
+		{
+			if (mapping != nullptr)
+				CloseHandle(mapping);
+			CloseHandle(file);
+
+			return K_FALSE;
+		}
+
+		_fileHandle = file;
+		_mappingHandle = mapping;
+		_data = (u8*)data;
+		_byteSize = (usize)byteSize.QuadPart;
+#else
+		const int file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return K_FALSE;
+
+		struct stat fileStat = {};
+		void* data = MAP_FAILED;
+		if (fstat(file, &fileStat) == 0 && fileStat.st_size != 0)
+			data = mmap(nullptr, (usize)fileStat.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+		// The mapping keeps its own reference to the file
+		close(file);
+		if (data == MAP_FAILED)
+			return K_FALSE;
+
+		_data = (u8*)data;
+		_byteSize = (usize)fileStat.st_size;
+#endif
+
+		return K_TRUE;
+	}
+
+	void cMappedFile::Close()
+	{
+		if (_data == nullptr)
+			return;
+
+#if defined(_WIN32)
+		UnmapViewOfFile(_data);
+		CloseHandle((HANDLE)_mappingHandle);
+		CloseHandle((HANDLE)_fileHandle);
+		_mappingHandle = nullptr;
+		_fileHandle = nullptr;
+#else
+		munmap(_data, _byteSize);
+#endif
+
+		_data = nullptr;
+		_byteSize = 0;
+	}
+
+	boolean cSnapshot::Write(const std::string& path, sSnapshotHeader header, const void* slots, usize slotByteSize, const u8* const* chunks)
+	{
+		std::ofstream outputFile(path, std::ios::binary | std::ios::trunc);
+		if (!outputFile)
+		{
+			Print("Error: can't write snapshot '" + path + "'!");
+
+			return K_FALSE;
+		}
+
+		header.magic = K_SNAPSHOT_MAGIC;
+		header.version = K_SNAPSHOT_VERSION;
+		header.slotsOffset = AlignSnapshotOffset(sizeof(sSnapshotHeader));
+		header.chunksOffset = AlignSnapshotOffset(header.slotsOffset + slotByteSize);
+		header.byteSize = header.chunksOffset + header.chunkCount * header.chunkByteSize;
+
+		outputFile.write((const char*)&header, sizeof(header));
+		WritePadding(outputFile, sizeof(header));
+		outputFile.write((const char*)slots, slotByteSize);
+		WritePadding(outputFile, header.slotsOffset + slotByteSize);
+		for (u64 i = 0; i < header.chunkCount; i++)
+			outputFile.write((const char*)chunks[i], header.chunkByteSize);
+
+		return outputFile.good() ? K_TRUE : K_FALSE;
+	}
+
+	const sSnapshotHeader* cSnapshot::Read(const cMappedFile* file)
+	{
+		if (file->GetData() == nullptr || file->GetByteSize() < sizeof(sSnapshotHeader))
+			return nullptr;
+
+		const sSnapshotHeader* header = (const sSnapshotHeader*)file->GetData();
+		if (header->magic != K_SNAPSHOT_MAGIC || header->version != K_SNAPSHOT_VERSION)
+		{
+			Print("Error: snapshot has unknown format or version!");
+
+			return nullptr;
+		}
+
+		// Chunk size comes from the descriptor, a chunk stride below the alignment would misalign the following chunks
+		if (header->byteSize != file->GetByteSize() || header->chunkByteSize % K_SNAPSHOT_ALIGNMENT != 0 ||
+			header->chunksOffset + header->chunkCount * header->chunkByteSize != header->byteSize)
+		{
+			Print("Error: snapshot is truncated or corrupt!");
+
+			return nullptr;
+		}
+
+		return header;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+// snapshot.hpp
+
+#pragma once
+
+#include <string>
+#include "types.hpp"
+
+namespace triton
+{
+	// Types stored in a snapshot are restored by raw bytes plus an iObject header fix-up (vtable and context),
+	// so a type may opt in only if every other member stays valid in another process and at another address.
+	// Opt in by specializing: template <> struct sSnapshotRelocatable<cMyType> { static constexpr types::boolean value = types::K_TRUE; };
+	template <typename T>
+	struct sSnapshotRelocatable
+	{
+		static constexpr types::boolean value = types::K_FALSE;
+	};
+
+	// Blob layout: header, slot index at slotsOffset, then chunkCount chunks of chunkByteSize at chunksOffset.
+	// Offsets are aligned to K_SNAPSHOT_ALIGNMENT so a mapped view can be used in place.
+	struct sSnapshotHeader
+	{
+		types::u32 magic = 0;
+		types::u32 version = 0;
+		types::u32 type = 0;
+		types::u32 objectByteSize = 0;
+		types::u64 objectCountPerChunk = 0;
+		types::u64 chunkByteSize = 0;
+		types::u64 chunkCount = 0;
+		types::u64 elementCount = 0;
+		types::u64 slotCount = 0;
+		types::u64 slotsOffset = 0;
+		types::u64 chunksOffset = 0;
+		types::u64 byteSize = 0;
+		types::u64 identifierSequence = 0;
+	};
+
+	// Copy-on-write view of a whole file, fix-ups write private pages and never reach the file
+	class cMappedFile
+	{
+	public:
+		explicit cMappedFile() = default;
+		~cMappedFile();
+
+		cMappedFile(const cMappedFile& rhs) = delete;
+		cMappedFile& operator=(const cMappedFile& rhs) = delete;
+
+		types::boolean Open(const std::string& path);
+		void Close();
+
+		inline types::u8* GetData() const { return _data; }
+		inline types::usize GetByteSize() const { return _byteSize; }
+
+	private:
+		types::u8* _data = nullptr;
+		types::usize _byteSize = 0;
+		void* _fileHandle = nullptr;
+		void* _mappingHandle = nullptr;
+	};
+
+	class cSnapshot
+	{
+	public:
+		static constexpr types::u32 K_SNAPSHOT_MAGIC = 0x4E535254; // "TRSN"
+		static constexpr types::u32 K_SNAPSHOT_VERSION = 2;
+		static constexpr types::usize K_SNAPSHOT_ALIGNMENT = 64;
+
+	public:
+		static types::boolean Write(const std::string& path, sSnapshotHeader header, const void* slots, types::usize slotByteSize, const types::u8* const* chunks);
+		static const sSnapshotHeader* Read(const cMappedFile* file);
+	};
+}
\ No newline at end of file
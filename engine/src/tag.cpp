@@ -1,41 +1,61 @@
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#endif
 #include "tag.hpp"
 
 using namespace types;
 
 namespace triton
 {
-	cTag::cTag()
-	{
-		FillZeros();
-	}
-
-	cTag::cTag(const std::string& text) : cTag(context)
+	cTag::cTag(const std::string& text) : cTag()
 	{
 		CopyChars((const u8*)text.c_str(), text.size());
 	}
 
-	cTag::cTag(const u8* chars, usize charsByteSize) : cTag(context)
+	cTag::cTag(const u8* chars, usize charsByteSize) : cTag()
 	{
 		CopyChars(chars, charsByteSize);
 	}
 
-	boolean cTag::Compare(const std::string& text)
+	boolean cTag::Compare(const std::string& text) const
 	{
 		if (text.size() != _byteSize)
 			return K_FALSE;
 
-		for (usize i = 0; i < _byteSize; i++)
-		{
-			if (text[i] != _data[i])
-				return K_FALSE;
-		}
+		return memcmp(text.data(), &_data[0], _byteSize) == 0 ? K_TRUE : K_FALSE;
+	}
+
+	boolean cTag::CompareData(const cTag& tag) const
+	{
+#if defined(__AVX2__)
+		const __m256i lhs = _mm256_loadu_si256((const __m256i*)&_data[0]);
+		const __m256i rhs = _mm256_loadu_si256((const __m256i*)&tag._data[0]);
+
+		return (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(lhs, rhs)) == 0xFFFFFFFF ? K_TRUE : K_FALSE;
+#elif defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+		const __m128i lhsLow = _mm_loadu_si128((const __m128i*)&_data[0]);
+		const __m128i lhsHigh = _mm_loadu_si128((const __m128i*)&_data[16]);
+		const __m128i rhsLow = _mm_loadu_si128((const __m128i*)&tag._data[0]);
+		const __m128i rhsHigh = _mm_loadu_si128((const __m128i*)&tag._data[16]);
+		const __m128i equal = _mm_and_si128(_mm_cmpeq_epi8(lhsLow, rhsLow), _mm_cmpeq_epi8(lhsHigh, rhsHigh));
 
-		return K_TRUE;
+		return _mm_movemask_epi8(equal) == 0xFFFF ? K_TRUE : K_FALSE;
+#else
+		u64 lhs[kMaxTagByteSize / sizeof(u64)];
+		u64 rhs[kMaxTagByteSize / sizeof(u64)];
+		memcpy(&lhs[0], &_data[0], kMaxTagByteSize);
+		memcpy(&rhs[0], &tag._data[0], kMaxTagByteSize);
+
+		return ((lhs[0] ^ rhs[0]) | (lhs[1] ^ rhs[1]) | (lhs[2] ^ rhs[2]) | (lhs[3] ^ rhs[3])) == 0 ? K_TRUE : K_FALSE;
+#endif
 	}
 
 	void cTag::FillZeros()
 	{
 		memset(&_data[0], 0, kMaxTagByteSize);
+		_byteSize = 0;
+		_hash = kEmptyHash;
 	}
 
 	void cTag::CopyChars(const u8* chars, usize charsByteSize)
@@ -43,7 +63,9 @@ namespace triton
 		if (chars == nullptr || charsByteSize == 0 || charsByteSize >= kMaxTagByteSize)
 			return;
 
+		FillZeros();
 		_byteSize = charsByteSize;
 		memcpy(&_data[0], &chars[0], _byteSize);
+		_hash = cHash::ComputeRuntime(&_data[0], _byteSize);
 	}
 }
\ No newline at end of file
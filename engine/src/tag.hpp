@@ -2,6 +2,7 @@
 
 #include <string>
 #include <array>
+#include "hash.hpp"
 #include "types.hpp"
 
 namespace triton
@@ -9,31 +10,74 @@ namespace triton
     class cContext;
     class cIdentifier;
     
+    // Tags are zero-padded to kMaxTagByteSize and carry a hash computed on construction,
+    // so equality is a hash check followed by one fixed-size compare of the whole array.
     class cTag
     {
         friend class cIdentifier;
 
     public:
         static constexpr types::usize kMaxTagByteSize = 32;
+        static constexpr types::u64 kEmptyHash = cHash::Compute("", 0);
         using chars = std::array<types::u8, kMaxTagByteSize>;
 
     public:
-        explicit cTag();
+        constexpr explicit cTag() = default;
         explicit cTag(const std::string& text);
         explicit cTag(const types::u8* chars, types::usize charsByteSize);
+        template <types::usize N>
+        constexpr explicit cTag(const char (&text)[N]);
         ~cTag() = default;
 
-        types::boolean Compare(const std::string& text);
+        types::boolean Compare(const std::string& text) const;
+        inline types::boolean Compare(const cTag& tag) const;
 
-        inline const chars& GetData() const { return _data; }
-        inline types::usize GetByteSize() const { return _byteSize; }
+        inline types::boolean operator==(const cTag& tag) const { return Compare(tag); }
+        inline types::boolean operator!=(const cTag& tag) const { return Compare(tag) == types::K_FALSE; }
+
+        constexpr const chars& GetData() const { return _data; }
+        constexpr types::usize GetByteSize() const { return _byteSize; }
+        constexpr types::u64 GetHash() const { return _hash; }
+
+        static constexpr types::u64 MakeHash(const chars& data, types::usize byteSize);
 
     private:
         void FillZeros();
         void CopyChars(const types::u8* chars, types::usize charsByteSize);
+        types::boolean CompareData(const cTag& tag) const;
 
     private:
         chars _data = {};
         types::usize _byteSize = 0;
+        types::u64 _hash = kEmptyHash;
     };
+
+    template <types::usize N>
+    constexpr cTag::cTag(const char (&text)[N])
+    {
+        static_assert(N > 0 && N - 1 < kMaxTagByteSize, "Tag literal doesn't fit into kMaxTagByteSize!");
+
+        _byteSize = N - 1;
+        for (types::usize i = 0; i < _byteSize; i++)
+            _data[i] = (types::u8)text[i];
+        _hash = MakeHash(_data, _byteSize);
+    }
+
+    struct sTagHasher
+    {
+        inline types::usize operator()(const cTag& tag) const { return (types::usize)tag.GetHash(); }
+    };
+
+    types::boolean cTag::Compare(const cTag& tag) const
+    {
+        if (_hash != tag._hash || _byteSize != tag._byteSize)
+            return types::K_FALSE;
+
+        return CompareData(tag);
+    }
+
+    constexpr types::u64 cTag::MakeHash(const chars& data, types::usize byteSize)
+    {
+        return cHash::Compute(data.data(), byteSize);
+    }
 }
\ No newline at end of file
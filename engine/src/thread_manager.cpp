@@ -3,7 +3,16 @@
 #pragma once
 
 #include <iostream>
+#include <chrono>
+#include <cstring>
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#elif defined(_M_ARM64) || defined(_M_ARM)
+#include <intrin.h>
+#endif
 #include "application.hpp"
+#include "context.hpp"
+#include "memory_pool.hpp"
 #include "thread_manager.hpp"
 #include "buffer.hpp"
 
@@ -11,51 +20,191 @@ using namespace types;
 
 namespace triton
 {
-    cTask::cTask(cBuffer* data, TaskFunction&& function) : _data(data), _function(std::make_shared<TaskFunction>(std::move(function)))
+    // Lets Submit tell its own workers apart from external threads, which go through the injection queue
+    static thread_local cThread* currentThreadPool = nullptr;
+    static thread_local usize currentWorkerIndex = 0;
+
+    // Tells the core a spin-wait is running, so it can give the sibling hyperthread its pipeline or save power
+    static inline void PauseSpin()
+    {
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        _mm_pause();
+#elif defined(_M_ARM64) || defined(_M_ARM)
+        __yield();
+#elif defined(__aarch64__) || defined(__arm__)
+        __asm__ __volatile__("yield");
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    cTask::cTask(cTask&& rhs) noexcept
     {
+        MoveFrom(rhs);
+    }
+
+    cTask& cTask::operator=(cTask&& rhs) noexcept
+    {
+        if (this != &rhs)
+        {
+            Reset();
+            MoveFrom(rhs);
+        }
+
+        return *this;
+    }
+
+    cTask::~cTask()
+    {
+        Reset();
     }
 
     void cTask::Run()
     {
-        if (_function)
-            _function->operator()(_data);
+        if (_operations != nullptr)
+            _operations->invoke(&_storage[0], _data);
+    }
+
+    void cTask::MoveFrom(cTask& rhs)
+    {
+        _data = rhs._data;
+        _operations = rhs._operations;
+        if (_operations == nullptr)
+            return;
+
+        if (_operations->move != nullptr)
+            _operations->move(&_storage[0], &rhs._storage[0]);
+        else
+            std::memcpy(&_storage[0], &rhs._storage[0], K_TASK_STORAGE_BYTE_SIZE);
+
+        rhs._data = nullptr;
+        rhs._operations = nullptr;
     }
 
-    cThread::cThread(cContext* context, usize threadCount) : iObject(context), _stop(K_FALSE)
+    void cTask::Reset()
     {
-        for (usize i = 0; i < threadCount; ++i)
+        if (_operations != nullptr && _operations->destroy != nullptr)
+            _operations->destroy(&_storage[0]);
+
+        _data = nullptr;
+        _operations = nullptr;
+    }
+
+    cWorkStealingDeque::cWorkStealingDeque()
+    {
+        sWorkStealingBuffer* buffer = AllocateBuffer(K_INITIAL_CAPACITY);
+        _buffers.push_back(buffer);
+        _buffer.store(buffer, std::memory_order_relaxed);
+    }
+
+    cWorkStealingDeque::~cWorkStealingDeque()
+    {
+        for (sWorkStealingBuffer* buffer : _buffers)
         {
-            _threads.emplace_back([this] {
-                while (K_TRUE)
-                {
-                    if (_pause.load() == K_TRUE)
-                        continue;
-
-                    cTask task;
-                    {
-                        std::unique_lock<std::mutex> lock(_mtx);
-                        _cv.wait(lock, [this] {
-                            return !_tasks.empty() || _stop;
-                        });
-                        if (_stop && _tasks.empty())
-                            return;
-                        task = _tasks.front();
-                        _tasks.pop();
-                    }
-                    task.Run();
-                }
-            });
+            delete[] buffer->tasks;
+            delete buffer;
+        }
+    }
+
+    void cWorkStealingDeque::Push(cTask* task)
+    {
+        const s64 bottom = _bottom.load(std::memory_order_relaxed);
+        const s64 top = _top.load(std::memory_order_acquire);
+        sWorkStealingBuffer* buffer = _buffer.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity - 1)
+            buffer = Grow(buffer, bottom, top);
+
+        buffer->tasks[bottom & (buffer->capacity - 1)].store(task, std::memory_order_relaxed);
+        // Publishes the task, and everything written to it, to thieves that acquire bottom
+        _bottom.store(bottom + 1, std::memory_order_release);
+    }
+
+    cTask* cWorkStealingDeque::Pop()
+    {
+        const s64 bottom = _bottom.load(std::memory_order_relaxed) - 1;
+        sWorkStealingBuffer* buffer = _buffer.load(std::memory_order_relaxed);
+        _bottom.store(bottom, std::memory_order_relaxed);
+        // Orders the bottom reservation before reading top, pairs with the fence in Steal
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        s64 top = _top.load(std::memory_order_relaxed);
+
+        if (top > bottom)
+        {
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+
+            return nullptr;
         }
+
+        cTask* task = buffer->tasks[bottom & (buffer->capacity - 1)].load(std::memory_order_relaxed);
+        if (top == bottom)
+        {
+            // Last task, race the thieves for it through top
+            if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                task = nullptr;
+            _bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+
+        return task;
+    }
+
+    cTask* cWorkStealingDeque::Steal()
+    {
+        s64 top = _top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const s64 bottom = _bottom.load(std::memory_order_acquire);
+
+        if (top >= bottom)
+            return nullptr;
+
+        sWorkStealingBuffer* buffer = _buffer.load(std::memory_order_acquire);
+        cTask* task = buffer->tasks[top & (buffer->capacity - 1)].load(std::memory_order_relaxed);
+        if (!_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+
+        return task;
+    }
+
+    sWorkStealingBuffer* cWorkStealingDeque::Grow(sWorkStealingBuffer* buffer, s64 bottom, s64 top)
+    {
+        sWorkStealingBuffer* grownBuffer = AllocateBuffer(buffer->capacity * 2);
+        for (s64 i = top; i < bottom; i++)
+            grownBuffer->tasks[i & (grownBuffer->capacity - 1)].store(buffer->tasks[i & (buffer->capacity - 1)].load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+        _buffers.push_back(grownBuffer);
+        _buffer.store(grownBuffer, std::memory_order_release);
+
+        return grownBuffer;
+    }
+
+    sWorkStealingBuffer* cWorkStealingDeque::AllocateBuffer(s64 capacity)
+    {
+        sWorkStealingBuffer* buffer = new sWorkStealingBuffer();
+        buffer->capacity = capacity;
+        buffer->tasks = new std::atomic<cTask*>[(usize)capacity];
+
+        return buffer;
+    }
+
+    cThread::cThread(cContext* context, usize threadCount) : iObject(context)
+    {
+        _workerCount = threadCount > 0 ? threadCount : 1;
+        _injectedTasks.resize(K_INITIAL_INJECTION_CAPACITY, nullptr);
+        _workers = new sThreadWorker[_workerCount];
+        for (usize i = 0; i < _workerCount; ++i)
+            _workers[i]._randomState = 0x9E3779B97F4A7C15ull * (i + 1);
+
+        for (usize i = 0; i < _workerCount; ++i)
+            _threads.emplace_back([this, i] { RunWorker(i); });
     }
 
     cThread::~cThread()
     {
         Stop();
 
-        _cv.notify_all();
-
         for (auto& thread : _threads)
             thread.join();
+
+        delete[] _workers;
     }
 
     void cThread::Pause()
@@ -65,22 +214,264 @@ namespace triton
 
     void cThread::Resume()
     {
-        _pause.store(K_FALSE);
+        // Stored under the lock, so a worker can't check the flag and then miss the wakeup
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _pause.store(K_FALSE);
+        }
+
+        _cv.notify_all();
+    }
+
+    sThreadWorkerStats cThread::GetWorkerStats(usize workerIndex) const
+    {
+        sThreadWorkerStats stats;
+        if (workerIndex >= _workerCount)
+            return stats;
+
+        const sThreadWorker& worker = _workers[workerIndex];
+        stats.spinNanoseconds = worker._spinNanoseconds.load(std::memory_order_relaxed);
+        stats.parkedNanoseconds = worker._parkedNanoseconds.load(std::memory_order_relaxed);
+        stats.parkCount = worker._parkCount.load(std::memory_order_relaxed);
+
+        return stats;
+    }
+
+    void cThread::ResetWorkerStats()
+    {
+        for (usize i = 0; i < _workerCount; i++)
+        {
+            _workers[i]._spinNanoseconds.store(0, std::memory_order_relaxed);
+            _workers[i]._parkedNanoseconds.store(0, std::memory_order_relaxed);
+            _workers[i]._parkCount.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void cThread::Submit(cTask&& task)
+    {
+        Enqueue(new (AllocateTask()) cTask(std::move(task)));
+    }
+
+    void cThread::Enqueue(cTask* queuedTask)
+    {
+        // Counted before the push, so a worker that takes the task never sees the count go below zero
+        _queuedCount.fetch_add(1, std::memory_order_seq_cst);
+
+        if (currentThreadPool == this)
+        {
+            _workers[currentWorkerIndex]._deque.Push(queuedTask);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> lock(_injectionMutex);
+            PushInjected(queuedTask);
+        }
+
+        WakeWorker();
     }
 
-    void cThread::Submit(cTask& task)
+    void cThread::Stop()
     {
         {
+            std::lock_guard<std::mutex> lock(_mtx);
+            _stop.store(K_TRUE);
+        }
+
+        _cv.notify_all();
+    }
+
+    void cThread::RunWorker(usize workerIndex)
+    {
+        currentThreadPool = this;
+        currentWorkerIndex = workerIndex;
+
+        while (K_TRUE)
+        {
+            // Stop overrides pause, queued tasks are drained before a stopped pool lets its workers exit
+            if (_pause.load() == K_TRUE && _stop.load() == K_FALSE)
+            {
+                Park(workerIndex);
+                continue;
+            }
+
+            cTask* task = FindTask(workerIndex);
+            if (task == nullptr)
+                task = SpinForTask(workerIndex);
+
+            if (task != nullptr)
+            {
+                _queuedCount.fetch_sub(1, std::memory_order_relaxed);
+                task->Run();
+                DeallocateTask(task);
+                continue;
+            }
+
+            if (_stop.load() == K_TRUE && _queuedCount.load() == 0)
+                return;
+
+            Park(workerIndex);
+        }
+    }
+
+    cTask* cThread::SpinForTask(usize workerIndex)
+    {
+        const u32 spinCount = _spinCount.load(std::memory_order_relaxed);
+        if (spinCount == 0)
+            return nullptr;
+
+        const auto spinStart = std::chrono::steady_clock::now();
+
+        // Polls the queued count, which stays in the local cache until a submit changes it,
+        // and only goes through the deques when there's something to find
+        cTask* task = nullptr;
+        for (u32 i = 0; i < spinCount && task == nullptr; i++)
+        {
+            if (_pause.load(std::memory_order_relaxed) == K_TRUE || _stop.load(std::memory_order_relaxed) == K_TRUE)
+                break;
+
+            PauseSpin();
+            if (_queuedCount.load(std::memory_order_relaxed) != 0)
+                task = FindTask(workerIndex);
+        }
+
+        const auto spinTime = std::chrono::steady_clock::now() - spinStart;
+        _workers[workerIndex]._spinNanoseconds.fetch_add((u64)std::chrono::duration_cast<std::chrono::nanoseconds>(spinTime).count(), std::memory_order_relaxed);
+
+        return task;
+    }
+
+    void cThread::Park(usize workerIndex)
+    {
+        const auto parkStart = std::chrono::steady_clock::now();
+
+        {
+            // A paused worker stays parked when tasks arrive, Resume and Stop wake everyone
             std::unique_lock<std::mutex> lock(_mtx);
-            _tasks.emplace(task);
+            _sleepingCount.fetch_add(1, std::memory_order_seq_cst);
+            _cv.wait(lock, [this] {
+                return _stop.load() == K_TRUE || (_pause.load() == K_FALSE && _queuedCount.load(std::memory_order_seq_cst) != 0);
+            });
+            _sleepingCount.fetch_sub(1, std::memory_order_relaxed);
         }
 
+        sThreadWorker& worker = _workers[workerIndex];
+        const auto parkTime = std::chrono::steady_clock::now() - parkStart;
+        worker._parkedNanoseconds.fetch_add((u64)std::chrono::duration_cast<std::chrono::nanoseconds>(parkTime).count(), std::memory_order_relaxed);
+        worker._parkCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    cTask* cThread::FindTask(usize workerIndex)
+    {
+        cTask* task = _workers[workerIndex]._deque.Pop();
+        if (task != nullptr)
+            return task;
+
+        task = TakeInjected(workerIndex);
+        if (task != nullptr)
+            return task;
+
+        return StealTask(workerIndex);
+    }
+
+    cTask* cThread::TakeInjected(usize workerIndex)
+    {
+        // Idle workers poll here constantly, only take the lock when there's something to take
+        if (_injectedCount.load(std::memory_order_relaxed) == 0)
+            return nullptr;
+
+        std::lock_guard<std::mutex> lock(_injectionMutex);
+        if (_injectedCount.load(std::memory_order_relaxed) == 0)
+            return nullptr;
+
+        // Taking a share of the queue at once spreads external bursts over the deques, where they can be stolen
+        cTask* task = PopInjected();
+
+        usize batchCount = _injectedCount.load(std::memory_order_relaxed) / _workerCount;
+        if (batchCount > K_INJECTION_BATCH_COUNT)
+            batchCount = K_INJECTION_BATCH_COUNT;
+
+        cWorkStealingDeque& deque = _workers[workerIndex]._deque;
+        for (usize i = 0; i < batchCount; i++)
+            deque.Push(PopInjected());
+
+        return task;
+    }
+
+    void cThread::PushInjected(cTask* task)
+    {
+        const usize count = _injectedCount.load(std::memory_order_relaxed);
+        const usize capacity = _injectedTasks.size();
+        if (count == capacity)
+        {
+            std::vector<cTask*> grownTasks(capacity * 2, nullptr);
+            for (usize i = 0; i < count; i++)
+                grownTasks[i] = _injectedTasks[(_injectedHead + i) & (capacity - 1)];
+
+            _injectedTasks.swap(grownTasks);
+            _injectedHead = 0;
+        }
+
+        _injectedTasks[(_injectedHead + count) & (_injectedTasks.size() - 1)] = task;
+        _injectedCount.store(count + 1, std::memory_order_relaxed);
+    }
+
+    cTask* cThread::PopInjected()
+    {
+        cTask* task = _injectedTasks[_injectedHead];
+        _injectedHead = (_injectedHead + 1) & (_injectedTasks.size() - 1);
+        _injectedCount.store(_injectedCount.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+
+        return task;
+    }
+
+    cTask* cThread::StealTask(usize workerIndex)
+    {
+        if (_workerCount < 2)
+            return nullptr;
+
+        // xorshift start victim, then one pass over every other worker
+        u64& state = _workers[workerIndex]._randomState;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+
+        const usize firstVictim = (usize)(state % _workerCount);
+        for (usize i = 0; i < _workerCount; i++)
+        {
+            const usize victim = (firstVictim + i) % _workerCount;
+            if (victim == workerIndex)
+                continue;
+
+            cTask* task = _workers[victim]._deque.Steal();
+            if (task != nullptr)
+                return task;
+        }
+
+        return nullptr;
+    }
+
+    void cThread::WakeWorker()
+    {
+        // Pairs with the sleeping count a worker publishes before it checks the queued count
+        if (_sleepingCount.load(std::memory_order_seq_cst) == 0)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(_mtx);
+        }
         _cv.notify_one();
     }
 
-    void cThread::Stop()
+    void* cThread::AllocateTask()
+    {
+        // Records come from the calling thread's allocator magazine and go back to the freeing worker's,
+        // so steady submission recycles blocks without reaching the shared bins or the heap
+        return _context->GetMemoryAllocator()->Allocate(sizeof(cTask), alignof(cTask));
+    }
+
+    void cThread::DeallocateTask(cTask* task)
     {
-        std::unique_lock<std::mutex> lock(_mtx);
-        _stop = K_TRUE;
+        task->~cTask();
+        _context->GetMemoryAllocator()->Deallocate(task);
     }
 }
\ No newline at end of file
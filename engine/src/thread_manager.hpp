@@ -3,10 +3,13 @@
 #pragma once
 
 #include <thread>
-#include <queue>
+#include <vector>
 #include <functional>
 #include <mutex>
-#include <memory>
+#include <condition_variable>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <atomic>
 #include "object.hpp"
 #include "types.hpp"
@@ -18,41 +21,202 @@ namespace triton
 
     using TaskFunction = std::function<void(cBuffer* const data)>;
 
+    struct sTaskOperations
+    {
+        using InvokeFunction = void (*)(types::u8* storage, cBuffer* const data);
+        using MoveFunction = void (*)(types::u8* destination, types::u8* source);
+        using DestroyFunction = void (*)(types::u8* storage);
+
+        InvokeFunction invoke = nullptr;
+        // Null for trivially copyable callables, which are moved by copying the storage and never destroyed
+        MoveFunction move = nullptr;
+        DestroyFunction destroy = nullptr;
+    };
+
+    // Move-only task with the callable stored inline. A capture that doesn't fit K_TASK_STORAGE_BYTE_SIZE
+    // fails to compile instead of going to the heap, capture a pointer to bigger state.
     class cTask
     {
+    public:
+        static constexpr types::usize K_TASK_STORAGE_BYTE_SIZE = 64;
+        static constexpr types::usize K_TASK_STORAGE_ALIGNMENT = 16;
+
     public:
         cTask() = default;
-        explicit cTask(cBuffer* data, TaskFunction&& function);
-        ~cTask() = default;
+        template <typename F, typename = std::enable_if_t<!std::is_same<std::decay_t<F>, cTask>::value>>
+        explicit cTask(cBuffer* data, F&& function);
+        cTask(cTask&& rhs) noexcept;
+        cTask& operator=(cTask&& rhs) noexcept;
+        ~cTask();
+
+        cTask(const cTask& rhs) = delete;
+        cTask& operator=(const cTask& rhs) = delete;
 
         void Run();
         inline cBuffer* GetData() const { return _data; }
-        inline std::shared_ptr<TaskFunction> GetFunction() const { return _function; }
+        inline types::boolean IsEmpty() const { return _operations == nullptr ? types::K_TRUE : types::K_FALSE; }
+
+    private:
+        template <typename F>
+        static const sTaskOperations* GetOperations();
+        void MoveFrom(cTask& rhs);
+        void Reset();
 
     private:
+        alignas(K_TASK_STORAGE_ALIGNMENT) types::u8 _storage[K_TASK_STORAGE_BYTE_SIZE];
         cBuffer* _data = nullptr;
-        std::shared_ptr<TaskFunction> _function;
+        const sTaskOperations* _operations = nullptr;
+    };
+
+    template <typename F, typename>
+    cTask::cTask(cBuffer* data, F&& function) : _data(data)
+    {
+        using Callable = std::decay_t<F>;
+        static_assert(sizeof(Callable) <= K_TASK_STORAGE_BYTE_SIZE, "Task capture doesn't fit the inline task storage!");
+        static_assert(alignof(Callable) <= K_TASK_STORAGE_ALIGNMENT, "Task capture is over-aligned for the inline task storage!");
+        static_assert(std::is_nothrow_move_constructible<Callable>::value, "Task callable must be nothrow move constructible!");
+
+        new (&_storage[0]) Callable(std::forward<F>(function));
+        _operations = GetOperations<Callable>();
+    }
+
+    template <typename F>
+    const sTaskOperations* cTask::GetOperations()
+    {
+        // Constant-initialized, one table per callable type with no guard on first use
+        static const sTaskOperations operations = {
+            [](types::u8* storage, cBuffer* const data) { (*(F*)storage)(data); },
+            std::is_trivially_copyable<F>::value ? nullptr : (sTaskOperations::MoveFunction)[](types::u8* destination, types::u8* source) {
+                new (destination) F(std::move(*(F*)source));
+                ((F*)source)->~F();
+            },
+            std::is_trivially_destructible<F>::value ? nullptr : (sTaskOperations::DestroyFunction)[](types::u8* storage) { ((F*)storage)->~F(); }
+        };
+
+        return &operations;
+    }
+
+    struct sWorkStealingBuffer
+    {
+        types::s64 capacity = 0;
+        std::atomic<cTask*>* tasks = nullptr;
+    };
+
+    // Chase-Lev deque: the owning worker pushes and pops at the bottom (LIFO), thieves take from the top (FIFO).
+    // Only the owner grows the ring, replaced rings are kept until destruction since a thief may still read one.
+    class cWorkStealingDeque
+    {
+    public:
+        static constexpr types::s64 K_INITIAL_CAPACITY = 256;
+
+    public:
+        explicit cWorkStealingDeque();
+        ~cWorkStealingDeque();
+
+        cWorkStealingDeque(const cWorkStealingDeque& rhs) = delete;
+        cWorkStealingDeque& operator=(const cWorkStealingDeque& rhs) = delete;
+
+        void Push(cTask* task);
+        cTask* Pop();
+        cTask* Steal();
+
+        inline types::boolean IsEmpty() const { return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed) ? types::K_TRUE : types::K_FALSE; }
+
+    private:
+        sWorkStealingBuffer* Grow(sWorkStealingBuffer* buffer, types::s64 bottom, types::s64 top);
+        static sWorkStealingBuffer* AllocateBuffer(types::s64 capacity);
+
+    private:
+        alignas(64) std::atomic<types::s64> _top = { 0 };
+        alignas(64) std::atomic<types::s64> _bottom = { 0 };
+        std::atomic<sWorkStealingBuffer*> _buffer = { nullptr };
+        std::vector<sWorkStealingBuffer*> _buffers;
+    };
+
+    struct sThreadWorkerStats
+    {
+        types::u64 spinNanoseconds = 0;
+        types::u64 parkedNanoseconds = 0;
+        types::u64 parkCount = 0;
     };
 
+    struct alignas(64) sThreadWorker
+    {
+        cWorkStealingDeque _deque;
+        types::u64 _randomState = 0;
+        std::atomic<types::u64> _spinNanoseconds = { 0 };
+        std::atomic<types::u64> _parkedNanoseconds = { 0 };
+        std::atomic<types::u64> _parkCount = { 0 };
+    };
+
+    // Work-stealing pool. Submit from a worker pushes to that worker's deque, any other thread goes through
+    // the injection queue, which idle workers drain in batches. Idle workers steal from random victims
+    // before they spin briefly and then park on the condition variable. Paused workers park too, so a paused
+    // pool burns no CPU, and Resume wakes them all at once.
     class cThread : public iObject
     {
         TRITON_OBJECT(cThread)
 
+    public:
+        static constexpr types::usize K_INJECTION_BATCH_COUNT = 32;
+        static constexpr types::u32 K_DEFAULT_SPIN_COUNT = 1024;
+        static constexpr types::usize K_INITIAL_INJECTION_CAPACITY = 1024;
+
     public:
         explicit cThread(cContext* context, types::usize threadCount = std::thread::hardware_concurrency());
         ~cThread();
-        
-        void Submit(cTask& task);
+
+        void Submit(cTask&& task);
+        // Builds the task straight in its pooled record, submitting a lambda never touches the heap
+        template <typename F>
+        void Submit(cBuffer* data, F&& function);
         void Pause();
         void Resume();
         void Stop();
 
+        sThreadWorkerStats GetWorkerStats(types::usize workerIndex) const;
+        void ResetWorkerStats();
+
+        // Pause instructions an idle worker spends polling for work before it parks, 0 parks at once
+        inline void SetSpinCount(types::u32 spinCount) { _spinCount.store(spinCount, std::memory_order_relaxed); }
+        inline types::u32 GetSpinCount() const { return _spinCount.load(std::memory_order_relaxed); }
+        inline types::usize GetThreadCount() const { return _threads.size(); }
+
+    private:
+        void RunWorker(types::usize workerIndex);
+        cTask* FindTask(types::usize workerIndex);
+        cTask* TakeInjected(types::usize workerIndex);
+        void PushInjected(cTask* task);
+        cTask* PopInjected();
+        cTask* StealTask(types::usize workerIndex);
+        cTask* SpinForTask(types::usize workerIndex);
+        void Park(types::usize workerIndex);
+        void WakeWorker();
+        void Enqueue(cTask* task);
+        void* AllocateTask();
+        void DeallocateTask(cTask* task);
+
     private:
         std::vector<std::thread> _threads = {};
-        std::queue<cTask> _tasks = {};
+        sThreadWorker* _workers = nullptr;
+        types::usize _workerCount = 0;
+        // Power-of-two ring that only grows, so steady submission doesn't allocate
+        std::vector<cTask*> _injectedTasks = {};
+        types::usize _injectedHead = 0;
+        std::mutex _injectionMutex;
+        std::atomic<types::usize> _injectedCount = { 0 };
+        alignas(64) std::atomic<types::usize> _queuedCount = { 0 };
+        alignas(64) std::atomic<types::usize> _sleepingCount = { 0 };
         std::mutex _mtx;
         std::condition_variable _cv;
         std::atomic<types::boolean> _pause = types::K_FALSE;
-        types::boolean _stop = types::K_FALSE;
+        std::atomic<types::boolean> _stop = types::K_FALSE;
+        std::atomic<types::u32> _spinCount = { K_DEFAULT_SPIN_COUNT };
     };
+
+    template <typename F>
+    void cThread::Submit(cBuffer* data, F&& function)
+    {
+        Enqueue(new (AllocateTask()) cTask(data, std::forward<F>(function)));
+    }
 }
\ No newline at end of file